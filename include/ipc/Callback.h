@@ -1,6 +1,7 @@
 #ifndef _IPC_CALLBACK_H_
 #define _IPC_CALLBACK_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <ipc/ErrorCode.h>
@@ -51,6 +52,46 @@ public:
      */
     virtual void message_arrived(const ErrorCode &cause = ErrorCode::IPC_ERR_SUCCESS) {}
 
+    /**
+     * @brief Message filter callback function of a channel with user headers (see Options::header_size),
+     *        invoked with the header before the payload of the message is read
+     * 
+     * @param header user header of the message
+     * @return false to drop the message, its payload is then never read
+     */
+    virtual bool message_filter(const Buffer *header) { return true; }
+
+    /**
+     * @brief Message arrival callback function with the sequence number of the message,
+     *        hands the message to message_arrived(buf) unless overridden
+     * 
+     * @param buf payload of the message
+     * @param sequence 64-bit number of the message, counted per priority class of the channel
+     * @param lost messages of the class this reader missed right before this one,
+     *        because it was lapped or came back after a reconnect behind the other readers
+     */
+    virtual void message_arrived(const Buffer *buf, std::uint64_t sequence, std::uint64_t lost) { message_arrived(buf); }
+
+    /**
+     * @brief Message arrival callback function of a channel with user headers,
+     *        hands the message to message_arrived(buf, sequence, lost) unless overridden
+     * 
+     * @param header user header of the message
+     * @param buf payload of the message
+     */
+    virtual void message_arrived(const Buffer *header, const Buffer *buf, std::uint64_t sequence, std::uint64_t lost)
+    {
+        message_arrived(buf, sequence, lost);
+    }
+
+    /**
+     * @brief Messages skipped callback function, a reader of a lossy channel was lapped
+     *        by the writers and resumes after the overwritten messages
+     * 
+     * @param count number of messages lost, reported between the messages around the gap
+     */
+    virtual void message_skipped(std::uint32_t count) {}
+
     /**
      * @brief Message sending callback function
      * 
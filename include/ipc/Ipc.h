@@ -3,11 +3,13 @@
 
 #include <string>
 #include <memory>
+#include <chrono>
 #include <functional>
 #include <ipc/export.h>
 #include <ipc/def.h>
 #include <ipc/Buffer.h>
 #include <ipc/Callback.h>
+#include <ipc/Stats.h>
 
 namespace ipc
 {
@@ -17,7 +19,7 @@ class Ipc
 {
 public:
     Ipc() noexcept = default;
-    explicit Ipc(char const * name, const unsigned &mode = SENDER);
+    explicit Ipc(char const * name, const unsigned &mode = SENDER, Options const &options = {});
     Ipc(Ipc&& rhs) noexcept;
 
     ~Ipc();
@@ -30,7 +32,7 @@ public:
 
     unsigned mode() const noexcept;
 
-    bool connect(char const * name, const unsigned &mode = SENDER);
+    bool connect(char const * name, const unsigned &mode = SENDER, Options const &options = {});
 
     bool reconnect(unsigned mode);
 
@@ -40,13 +42,121 @@ public:
 
     bool is_connected() const noexcept;
 
-    bool write(void const * data, std::size_t size);
+    /**
+     * @brief Make this reader of a route a member of the consumer group `group`.
+     * 
+     * @note Every group receives every message, within a group each message goes to exactly one member.
+     *       Readers outside of any group keep receiving everything. Join before reading,
+     *       the membership lasts until the reader disconnects.
+     */
+    bool join(char const * group);
+
+    /**
+     * @brief Make the message with sequence number `sequence` the next one this reader receives.
+     * 
+     * @note The channel must retain messages (see Options::retain), and the message must still be
+     *       within the retained window. Call it before read() or between two calls of it.
+     */
+    bool seek(std::uint64_t sequence);
+
+    /**
+     * @brief Step this reader `count` messages back, to receive them again or the first time.
+     * 
+     * @note Same conditions as seek().
+     */
+    bool rewind(std::uint64_t count);
+
+    /**
+     * @brief Write a message into the ring of a priority class.
+     * 
+     * @note Readers drain higher classes first, the channel must have been created
+     *       with more than `priority` classes (see Options::priorities).
+     */
+    bool write(void const * data, std::size_t size, std::uint32_t priority = 0);
+
+    /**
+     * @brief Write a message, waiting up to `timeout` for a free slot while the ring is full.
+     * 
+     * @note The writer sleeps until a reader advances, it uses no CPU while blocked.
+     *       std::chrono::milliseconds::max() waits forever.
+     */
+    bool write(void const * data, std::size_t size, std::chrono::milliseconds timeout, std::uint32_t priority = 0);
+
+    /**
+     * @brief Write a message together with a user header of Options::header_size bytes.
+     * 
+     * @note The header is stored in the ring slot, readers see it in Callback::message_filter
+     *       before the payload is read. It is ignored on a channel without user headers.
+     */
+    bool write(void const * header, void const * data, std::size_t size, std::uint32_t priority = 0);
+
+    bool write(Buffer const & buff, std::uint32_t priority = 0);
+
+    bool write(std::string const & str, std::uint32_t priority = 0);
+
+    /**
+     * @brief Write several messages and publish them to the readers with a single index update.
+     * 
+     * @note Either all of the messages are queued or none of them,
+     *       and readers see all of them at once, never a part of the set.
+     */
+    bool write_batch(Buffer const * buffs, std::size_t count, std::uint32_t priority = 0);
+
+    /**
+     * @brief Stage a message for the next publish(), readers do not see it before that.
+     * 
+     * @note The message is copied, `data` may be reused right away.
+     */
+    bool stage(void const * data, std::size_t size);
+
+    /**
+     * @brief Publish the staged messages as one set, like write_batch(): all of them at once or none.
+     * 
+     * @note The staged set is cleared either way. It must fit into the ring, see Options::capacity.
+     */
+    bool publish(std::uint32_t priority = 0);
+
+    /**
+     * @brief Drop the staged messages without publishing them.
+     */
+    void unstage();
+    /**
+     * @brief Borrow room for a message of `size` bytes in the payload pool, to be filled in place.
+     * 
+     * @note Send it with commit() or give it back with discard(), no copy of the message is made.
+     *       The buffer is empty when the pool has no room left, or the channel carries inline
+     *       payloads only (see Options::overwrite and Options::retain). The pool holds the room
+     *       until then, loans still open on disconnect are given back.
+     */
+    Buffer loan(std::size_t size);
+    /**
+     * @brief Send a message obtained from loan(), its whole size as loaned.
+     * 
+     * @note If it fails, on a full ring for instance, the loan stays open and can be committed again.
+     */
+    bool commit(Buffer const & loan, std::uint32_t priority = 0);
+    /**
+     * @brief Give back a message obtained from loan() without sending it.
+     */
+    void discard(Buffer const & loan);
+
+    /**
+     * @brief Write a message under `key`.
+     * 
+     * @note On a conflating channel (see Options::conflate) it replaces the message of the same key
+     *       the reader has not taken yet, in its place in the ring. Elsewhere the key is ignored.
+     */
+    bool write_keyed(std::uint64_t key, void const * data, std::size_t size);
 
-    bool write(Buffer const & buff);
+    void read(std::uint64_t tm = static_cast<uint64_t>(TimeOut::INVALID_TIMEOUT));
 
-    bool write(std::string const & str);
+    /**
+     * @brief Ring usage of the channel, including the lag of every connected reader.
+     */
+    Stats stats() const;
 
-    void read(std::uint64_t tm = static_cast<uint64_t>(TimeOut::INVALID_TIMEOUT));
+private:
+    bool send(void const * header, void const * data, std::size_t size, std::uint64_t tm, std::uint32_t priority);
 
 private:
     struct IpcImpl;
@@ -72,6 +182,15 @@ using Route = Ipc<Wr<Transmission::BROADCAST>>;
  */
 using Channel = Ipc<Wr<Transmission::UNICAST>>;
 
+
+/**
+ * @brief work queue
+ * 
+ * @note Readers of a work queue compete for the messages: each message is consumed by exactly one of them,
+ *       so jobs can be spread over a pool of worker processes. A work queue could be used in N to M .
+ */
+using WorkQueue = Ipc<Wr<Transmission::WORKQUEUE>>;
+
 } // namespace ipc
 
 
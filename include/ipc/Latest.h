@@ -0,0 +1,111 @@
+#ifndef _IPC_LATEST_H_
+#define _IPC_LATEST_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <ipc/export.h>
+
+namespace ipc
+{
+
+/**
+ * @brief Latest value of a topic, kept in shared memory behind a sequence lock.
+ * 
+ * @note Writers overwrite the value in place, readers copy the newest value without
+ *       blocking or waking anybody. There is no history: a reader that is slower
+ *       than the writers only ever sees the most recent value.
+ */
+class IPC_EXPORT LatestBuffer
+{
+public:
+    LatestBuffer() noexcept;
+    LatestBuffer(char const * name, std::size_t size);
+    LatestBuffer(LatestBuffer&& rhs) noexcept;
+
+    ~LatestBuffer();
+
+    LatestBuffer& operator=(LatestBuffer rhs) noexcept;
+public:
+    /**
+     * @brief Open or create the value, the endpoint creating it decides its size.
+     */
+    bool connect(char const * name, std::size_t size);
+
+    void disconnect();
+
+    bool valid() const noexcept;
+
+    std::size_t size() const noexcept;
+
+    /**
+     * @brief Replace the value, size must be the size of the value.
+     */
+    bool write(void const * data, std::size_t size);
+
+    /**
+     * @brief Copy out the newest value, returns false if it was never written.
+     */
+    bool read(void * data, std::size_t size) const;
+
+    /**
+     * @brief Number of writes so far, lets a reader tell whether the value changed.
+     */
+    std::uint64_t version() const noexcept;
+
+private:
+    struct LatestImpl;
+    std::unique_ptr<LatestImpl> impl_;
+};
+
+template <typename T>
+class Latest
+{
+    static_assert(std::is_trivially_copyable<T>::value, "The value is copied byte-wise through shared memory.");
+
+public:
+    Latest() noexcept = default;
+    explicit Latest(char const * name)
+        : buff_{name, sizeof(T)}
+    {
+    }
+
+public:
+    bool connect(char const * name)
+    {
+        return buff_.connect(name, sizeof(T));
+    }
+
+    void disconnect()
+    {
+        buff_.disconnect();
+    }
+
+    bool valid() const noexcept
+    {
+        return buff_.valid();
+    }
+
+    bool write(T const & value)
+    {
+        return buff_.write(&value, sizeof(T));
+    }
+
+    bool read(T & value) const
+    {
+        return buff_.read(&value, sizeof(T));
+    }
+
+    std::uint64_t version() const noexcept
+    {
+        return buff_.version();
+    }
+
+private:
+    LatestBuffer buff_;
+};
+
+} // namespace ipc
+
+#endif // ! _IPC_LATEST_H_
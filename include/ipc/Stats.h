@@ -0,0 +1,40 @@
+#ifndef _IPC_STATS_H_
+#define _IPC_STATS_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace ipc {
+
+/**
+ * @brief Progress of one connected reader.
+ */
+struct ReaderStats
+{
+    // connection id of the reader
+    std::uint32_t id = 0;
+    // next ring index the reader consumes
+    std::uint32_t cursor = 0;
+    // messages published but not consumed yet by this reader
+    std::uint32_t lag = 0;
+    // messages lost to the writers lapping the reader, lossy channels only
+    std::uint32_t skipped = 0;
+};
+
+/**
+ * @brief Snapshot of the ring of a channel.
+ */
+struct Stats
+{
+    // number of ring slots
+    std::uint32_t capacity = 0;
+    // read index the writers work with, the slowest reader as of their last check
+    std::uint32_t rd = 0;
+    // write index
+    std::uint32_t wr = 0;
+    std::vector<ReaderStats> readers;
+};
+
+} // namespace ipc
+
+#endif // ! _IPC_STATS_H_
@@ -23,10 +23,51 @@ enum class TimeOut : std::uint64_t
     INVALID_TIMEOUT = (std::numeric_limits<std::uint64_t>::max)(),
 };
 
+// Number of descriptor slots in the ring of a channel, must be a power of two.
+enum class Capacity : std::uint32_t
+{
+    MIN_CAPACITY = 64,
+    DEFAULT_CAPACITY = 256,
+    MAX_CAPACITY = 1024 * 1024,
+};
+
+// Payloads up to the inline size of a channel are stored in the ring slot itself.
+enum class InlineSize : std::uint32_t
+{
+    DISABLED = 0,
+    MAX_INLINE_SIZE = 1024,
+};
+
+// User header stored in every ring slot, readers filter and dispatch on it without reading the payload.
+enum class HeaderSize : std::uint32_t
+{
+    DISABLED = 0,
+    MIN_HEADER_SIZE = 8,
+    MAX_HEADER_SIZE = 32,
+};
+
+// Payload pool of every sender, large payloads go there. It is mapped in extents as it fills up,
+// so a sender only ever maps what it has in flight.
+enum class PoolSize : std::uint32_t
+{
+    MIN_POOL_SIZE = 64 * 1024,
+    DEFAULT_POOL_SIZE = 1024 * 1024 * 1024,
+    MAX_POOL_SIZE = 2u * 1024 * 1024 * 1024,
+};
+
+// Priority classes of a channel, every class has a ring of its own and readers drain higher classes first.
+enum class Priority : std::uint32_t
+{
+    NORMAL = 0,
+    MAX_PRIORITIES = 4,
+};
+
 enum class Transmission : uint32_t
 {
     UNICAST,
-    BROADCAST
+    BROADCAST,
+    // readers compete for the messages, each message reaches exactly one of them
+    WORKQUEUE
 };
 
 // producer-consumer policy flag
@@ -34,6 +75,44 @@ template <Transmission Ts>
 struct Wr
 {
     constexpr static bool is_broadcast = (Ts == Transmission::BROADCAST);
+    constexpr static bool is_workqueue = (Ts == Transmission::WORKQUEUE);
+};
+
+// Per-channel settings.
+// The endpoint that creates the channel decides them, later endpoints adopt what is already in place.
+struct Options
+{
+    std::uint32_t capacity = static_cast<std::uint32_t>(Capacity::DEFAULT_CAPACITY);
+    // bytes reserved in every ring slot for small payloads, which then bypass the payload pool
+    std::uint32_t inline_size = static_cast<std::uint32_t>(InlineSize::DISABLED);
+    // every sender gets a private single-producer ring, drained round-robin by the only reader
+    bool lanes = false;
+    // rounds every ring slot up to a whole cache line, so neighbouring producers and consumers never share one
+    bool padded = false;
+    // writers never wait or fail on a full ring but overwrite the oldest message,
+    // a lapped reader skips ahead, payloads must fit inline
+    bool overwrite = false;
+    // number of priority classes, messages of class 0 (NORMAL) are read last
+    std::uint32_t priorities = 1;
+    // a full ring links to a new overflow segment of the same size instead of failing,
+    // the only reader follows the chain and overflow segments go away once drained
+    bool chained = false;
+    // readers share one read index and claim messages from it, set for a WorkQueue whatever is passed in
+    bool competing = false;
+    // a keyed message replaces the unread one of the same key instead of taking another slot,
+    // so a lagging reader only gets the latest value per key. Channels only, payloads must fit inline
+    bool conflate = false;
+    // bytes of user header every message carries in its ring slot, 0 or 8 to 32 (see HeaderSize)
+    std::uint32_t header_size = static_cast<std::uint32_t>(HeaderSize::DISABLED);
+    // the ring keeps at least the last `retain` messages after every reader took them, readers can seek back
+    // into them and new readers join at the live end. Writers are left capacity - retain slots of headroom,
+    // payloads must fit inline
+    std::uint32_t retain = 0;
+    // large payloads of a sender are carved from a ring in its pool and reclaimed oldest first,
+    // cheaper than the size classes as long as readers give payloads back roughly in order
+    bool fifo_pool = false;
+    // upper bound of the payload pool of every sender, see PoolSize. A payload may take up to half of it
+    std::uint32_t pool_size = static_cast<std::uint32_t>(PoolSize::DEFAULT_POOL_SIZE);
 };
 
 } // namespace ipc
@@ -6,15 +6,17 @@ namespace detail
 {
 
 Descriptor::Descriptor()
-    :Descriptor(std::thread::id(),std::size_t(),std::size_t())
+    :Descriptor(0, 0, 0)
 {
 
 }
 
-Descriptor::Descriptor(const std::thread::id &id,const std::size_t &offset, const std::size_t &len)
-    : id_(id)
+Descriptor::Descriptor(const std::uint32_t &producer, const std::uint32_t &offset, const std::uint32_t &len,
+                       const std::uint32_t &epoch)
+    : producer_(producer)
     , offset_(offset)
     , length_(len)
+    , epoch_(epoch)
 {
 
 }
@@ -24,36 +26,53 @@ Descriptor::~Descriptor()
 
 }
 
-void Descriptor::id(const std::thread::id &id)
+void Descriptor::producer(const std::uint32_t &producer)
 {
-    id_ = id;
+    producer_ = producer;
 }
 
-std::thread::id Descriptor::id() const
+std::uint32_t Descriptor::producer() const
 {
-    return id_;
+    return producer_;
 }
 
-void Descriptor::offset(const std::size_t &offset)
+void Descriptor::offset(const std::uint32_t &offset)
 {
     offset_ = offset;
 }
 
-std::size_t Descriptor::offset() const
+std::uint32_t Descriptor::offset() const
 {
     return offset_;
 }
 
-void Descriptor::length(const std::size_t &length)
+void Descriptor::length(const std::uint32_t &length)
 {
     length_ = length;
 }
 
-std::size_t Descriptor::length() const
+std::uint32_t Descriptor::length() const
 {
     return length_;
 }
 
+void Descriptor::epoch(const std::uint32_t &epoch)
+{
+    epoch_ = epoch;
+}
+
+std::uint32_t Descriptor::epoch() const
+{
+    return epoch_;
+}
+
+bool Descriptor::is_inline() const
+{
+    return producer_ == 0;
+}
+
+static_assert(sizeof(Descriptor) == 16, "A descriptor takes 16 bytes of a ring slot.");
+
 
 } // namespace detail
 } // namespace ipc
\ No newline at end of file
@@ -2,36 +2,46 @@
 #define _IPC_MESSAGE_H_
 
 #include <ipc/def.h>
-#include <thread>
+#include <cstdint>
 
 namespace ipc
 {
 namespace detail
 {
 
+// 16 bytes, four of them fit into a cache line.
 class Descriptor
 {
 public:
     Descriptor();
-    Descriptor(const std::thread::id &id,const std::size_t &offset, const std::size_t &len);
+    Descriptor(const std::uint32_t &producer, const std::uint32_t &offset, const std::uint32_t &len,
+               const std::uint32_t &epoch = 0);
     ~Descriptor();
 public:
-    void id(const std::thread::id &id);
-    std::thread::id id() const;
+    void producer(const std::uint32_t &producer);
+    std::uint32_t producer() const;
 
-    void offset(const std::size_t &offset);
-    std::size_t offset() const;
+    void offset(const std::uint32_t &offset);
+    std::uint32_t offset() const;
 
-    void length(const std::size_t &size);
-    std::size_t length() const;
+    void length(const std::uint32_t &size);
+    std::uint32_t length() const;
+
+    void epoch(const std::uint32_t &epoch);
+    std::uint32_t epoch() const;
+
+    // The payload is stored in the ring slot next to the descriptor, no producer pool is involved.
+    bool is_inline() const;
 
 private:
-    // data storage file name generate
-    std::thread::id id_;
-    // data offset
-    std::size_t offset_;
+    // connection slot of the sender owning the payload pool, 0 for inline payloads
+    std::uint32_t producer_;
+    // data offset in the payload pool
+    std::uint32_t offset_;
     // data length
-    std::size_t length_;
+    std::uint32_t length_;
+    // generation of the sender slot, tells the pool of a reused slot apart
+    std::uint32_t epoch_;
 };
 
 } // namespace detail
@@ -102,6 +102,15 @@ std::int32_t Handle::ref() const noexcept
     return acc_of(mem_, size_).load(std::memory_order_acquire);
 }
 
+void Handle::add_ref() noexcept
+{
+    if (mem_ == nullptr || size_ == 0)
+    {
+        return;
+    }
+    acc_of(mem_, size_).fetch_add(1, std::memory_order_acq_rel);
+}
+
 void Handle::sub_ref() noexcept
 {
     if (mem_ == nullptr || size_ == 0)
@@ -156,6 +165,10 @@ std::int32_t Handle::release()
     std::int32_t ret = -1;
     if (mem_ == nullptr || size_ == 0)
     {
+        if (fd_ != -1)
+        {
+            ::close(fd_);
+        }
     }
     else if ((ret = acc_of(mem_, size_).fetch_sub(1, std::memory_order_acq_rel)) <= 1)
     {
@@ -32,6 +32,7 @@ public:
     char const *name() const noexcept;
 
     std::int32_t ref() const noexcept;
+    void add_ref() noexcept;
     void sub_ref() noexcept;
 
     bool acquire(char const *name, std::size_t size, unsigned mode = create | open);
@@ -1,4 +1,9 @@
 #include <ipc/Ipc.h>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <mutex>
 #include <shared_mutex>
 #include <Handle.h>
 #include <MessageQueue.hpp>
@@ -19,6 +24,15 @@ namespace
     #define MODE           (impl_->mode)
     #define CONNECTED      (impl_->connected)
     #define CALLBACK       (impl_->callback)
+    #define GROUP          (impl_->group)
+    #define STAGED         (impl_->staged)
+    #define LOANS          (impl_->loans)
+
+    // Maximum number of descriptors drained from the ring per index update.
+    constexpr std::uint32_t READ_BATCH_SIZE = 32;
+
+    // How often a writer that ran out of room looks for readers that died without disconnecting.
+    constexpr std::chrono::milliseconds REAP_INTERVAL {100};
 } // internal-linkage
 
 
@@ -32,13 +46,87 @@ struct Ipc<Wr>::IpcImpl
     unsigned mode { SENDER };
     std::atomic_bool connected { false };
     CallbackPtr callback {nullptr};
+    // consumer group of a reader, joined again on every reconnect
+    std::string group {};
+    // messages waiting for publish()
+    std::vector<std::vector<char>> staged {};
+    // payloads loaned out of the pool and not committed yet, by the address handed out
+    std::vector<std::pair<void *, Descriptor>> loans {};
+    // held while popping, read() and a disconnect from another thread never move the cursors at once
+    std::mutex popping {};
+    // last time reap() looked for dead readers
+    std::chrono::steady_clock::time_point reaped {};
+
+    // Pops what reader `que` did not read yet, the pool references go back through `cache`.
+    template <typename Que>
+    static void drop_unread(Que *que, CacheBase *cache)
+    {
+        Descriptor descs[READ_BATCH_SIZE] {};
+        for (auto skipped = que->skipped(); !que->empty(); skipped = que->skipped())
+        {
+            if (!que->pop_n(descs, READ_BATCH_SIZE, [cache](Descriptor const &desc, void const *)
+                {
+                    return desc.is_inline() || cache->release(desc);
+                }) && (que->skipped() == skipped))
+            {
+                break;
+            }
+        }
+    }
+
+    // A leaving reader gives back the pool references of the messages it did not read,
+    // unless the next reader of a channel or another member of its group takes them over.
+    // Runs under the lock read() pops with, a read still going on in another thread is not overtaken.
+    void release_unread()
+    {
+        auto que = handle->queue();
+        if (que == nullptr || !fragment || !(mode & RECEIVER) || !que->orphans())
+        {
+            return;
+        }
+        std::lock_guard<std::mutex> guard {popping};
+        drop_unread(que, fragment.get());
+    }
+
+    // A reader whose process died never disconnects, it would hold the ring and its pool references forever.
+    // A writer that runs out of room looks for such readers, at most once per REAP_INTERVAL, and closes
+    // their connections the way they would have: the references go back to the pools, the ring moves on.
+    // Returns whether it found one.
+    bool reap()
+    {
+        auto que = handle->queue();
+        auto const now = std::chrono::steady_clock::now();
+        if (que == nullptr || !que->valid() || que->chained() || (now - reaped < REAP_INTERVAL))
+        {
+            return false;
+        }
+        reaped = now;
+        bool found = false;
+        while (auto cc_id = que->segment()->claim_dead())
+        {
+            found = true;
+            MessageQueue<Choose<Segment>> dead {nullptr, handle->name().c_str()};
+            if (!dead.init() || !dead.queue()->adopt(cc_id))
+            {
+                que->segment()->disconnect(RECEIVER, cc_id);
+                continue;
+            }
+            Cache<RECEIVER> cache;
+            if (dead.queue()->orphans() && cache.init(handle->name(), 0, 0))
+            {
+                drop_unread(dead.queue(), &cache);
+            }
+            dead.queue()->disconnect();
+        }
+        return found;
+    }
 };
 
 template <typename Wr>
-Ipc<Wr>::Ipc(char const * name, const unsigned &mode)
+Ipc<Wr>::Ipc(char const * name, const unsigned &mode, Options const &options)
     : impl_ {std::make_unique<Ipc<Wr>::IpcImpl>()}
 {
-    connect(name, mode);
+    connect(name, mode, options);
 }
 
 template <typename Wr>
@@ -80,8 +168,12 @@ unsigned Ipc<Wr>::mode() const noexcept
 }
 
 template <typename Wr>
-bool Ipc<Wr>::connect(char const * name, const unsigned &mode)
+bool Ipc<Wr>::connect(char const * name, const unsigned &mode, Options const &settings)
 {
+    // whether readers compete for the messages follows from the transmission
+    auto options = settings;
+    options.competing = Wr::is_workqueue;
+
     if (name == nullptr || name[0] == '\0')
     {
         if(CALLBACK)
@@ -91,10 +183,23 @@ bool Ipc<Wr>::connect(char const * name, const unsigned &mode)
         return false;
     }
 
+    // lanes, chained and conflating rings have a single consumer, a route fans out to many
+    if (!is_valid_options(options) || (Wr::is_broadcast && (options.lanes || options.chained || options.conflate)))
+    {
+        if(CALLBACK)
+        {
+            CALLBACK->connected(ErrorCode::IPC_ERR_INVAL);
+        }
+        return false;
+    }
+
+    // the old connection hands its loans and unread messages back through its own cache
+    disconnect();
+
     switch (mode)
     {
     case static_cast<unsigned>(SENDER):
-        FRAGMENT = std::make_unique<Cache<SENDER>>();
+        FRAGMENT = std::make_unique<Cache<SENDER>>(options);
         break;
     case static_cast<unsigned>(RECEIVER):
         FRAGMENT = std::make_unique<Cache<RECEIVER>>();
@@ -103,19 +208,9 @@ bool Ipc<Wr>::connect(char const * name, const unsigned &mode)
         break;
     }
 
-    if(!FRAGMENT->init())
-    {
-        if(CALLBACK)
-        {
-            CALLBACK->connected(ErrorCode::IPC_ERR_NOINIT);
-        }
-        return false;
-    }
-
-    disconnect();
     if(!valid())
     {
-        HANDLE = std::make_shared<MessageQueue<Choose<Segment>>>(nullptr,name);
+        HANDLE = std::make_shared<MessageQueue<Choose<Segment>>>(nullptr,name,options);
         if(!HANDLE->init())
         {
             if(CALLBACK)
@@ -171,7 +266,8 @@ bool Ipc<Wr>::reconnect(unsigned mode)
     if (mode & RECEIVER)
     {
         que->disconnect();
-        if (que->connect(mode))
+        if (que->connect(mode) && (GROUP.empty() || que->join(GROUP.c_str())) &&
+                FRAGMENT->init(HANDLE->name(), 0, 0))
         {
             if(CALLBACK)
             {
@@ -192,12 +288,22 @@ bool Ipc<Wr>::reconnect(unsigned mode)
         HANDLE->disconnect();
     }
 
+    // the payload pool is named after the connection slot, so it is set up once the slot is taken
+    if (!que->connect(mode) || !FRAGMENT->init(HANDLE->name(), que->connected_id(), que->epoch()))
+    {
+        if(CALLBACK)
+        {
+            CALLBACK->connected(ErrorCode::IPC_ERR_NOINIT);
+        }
+        return false;
+    }
+
     if(CALLBACK)
     {
         CALLBACK->connected();
     }
 
-    return que->connect(mode);
+    return true;
 }
 
 template <typename Wr>
@@ -221,6 +327,16 @@ void Ipc<Wr>::disconnect()
         return;
     }
     CONNECTED = false;
+    GROUP.clear();
+    if (FRAGMENT)
+    {
+        for (auto &loan : LOANS)
+        {
+            FRAGMENT->discard(loan.second);
+        }
+    }
+    LOANS.clear();
+    impl_->release_unread();
     que->disconnect();
     assert((HANDLE) != nullptr);
     HANDLE->disconnect();
@@ -247,7 +363,66 @@ bool Ipc<Wr>::is_connected() const noexcept
 }
 
 template <typename Wr>
-bool Ipc<Wr>::write(void const *data, std::size_t size)
+bool Ipc<Wr>::join(char const * group)
+{
+    if (!Wr::is_broadcast || !valid() || !CONNECTED || !(MODE & RECEIVER) || group == nullptr)
+    {
+        return false;
+    }
+    auto que = HANDLE->queue();
+    if (que == nullptr || !que->join(group))
+    {
+        return false;
+    }
+    GROUP = group;
+    return true;
+}
+
+template <typename Wr>
+bool Ipc<Wr>::seek(std::uint64_t sequence)
+{
+    if (!valid() || !CONNECTED || !(MODE & RECEIVER))
+    {
+        return false;
+    }
+    auto que = HANDLE->queue();
+    return (que != nullptr) && que->seek(sequence);
+}
+
+template <typename Wr>
+bool Ipc<Wr>::rewind(std::uint64_t count)
+{
+    if (!valid() || !CONNECTED || !(MODE & RECEIVER))
+    {
+        return false;
+    }
+    auto que = HANDLE->queue();
+    return (que != nullptr) && que->rewind(count);
+}
+
+template <typename Wr>
+bool Ipc<Wr>::write(void const *data, std::size_t size, std::uint32_t priority)
+{
+    return this->write(data, size, std::chrono::milliseconds::zero(), priority);
+}
+
+template <typename Wr>
+bool Ipc<Wr>::write(void const *data, std::size_t size, std::chrono::milliseconds timeout, std::uint32_t priority)
+{
+    // a zero timeout tries once, max() waits forever
+    auto const tm = (timeout == std::chrono::milliseconds::max()) ? static_cast<std::uint64_t>(TimeOut::INVALID_TIMEOUT) :
+        (timeout.count() > 0 ? static_cast<std::uint64_t>(timeout.count()) : 0);
+    return send(nullptr, data, size, tm, priority);
+}
+
+template <typename Wr>
+bool Ipc<Wr>::write(void const *header, void const *data, std::size_t size, std::uint32_t priority)
+{
+    return send(header, data, size, 0, priority);
+}
+
+template <typename Wr>
+bool Ipc<Wr>::send(void const *header, void const *data, std::size_t size, std::uint64_t tm, std::uint32_t priority)
 {
     if (!valid() || data == nullptr || size == 0)
     {
@@ -259,7 +434,7 @@ bool Ipc<Wr>::write(void const *data, std::size_t size)
     }
     auto que = HANDLE->queue();
     if (que == nullptr || que->segment() == nullptr || !que->connect() ||
-            !(que->segment()->connections()))
+            !(que->segment()->connections()) || priority >= que->priorities())
     {
         if(CALLBACK)
         {
@@ -268,9 +443,57 @@ bool Ipc<Wr>::write(void const *data, std::size_t size)
         return false;
     }
 
-    auto desc = FRAGMENT->write(data,size,que->segment()->recv_count());
-    if(!desc.length() || !que->push(desc))
+    // taken before the readers are counted for a pooled payload
+    auto const roster = que->roster();
+    if (size <= que->inline_size())
+    {
+        // small payloads travel in the ring slot, the payload pool is not involved at all
+        if (!que->push_wait([&]
+            {
+                return que->push_inline(Descriptor{0, 0, static_cast<std::uint32_t>(size)}, data, size, priority, header);
+            }, tm))
+        {
+            if (impl_->reap())
+            {
+                return send(header, data, size, tm, priority);
+            }
+            if(CALLBACK)
+            {
+                CALLBACK->delivery_complete(ErrorCode::IPC_ERR_INVAL);
+            }
+            return false;
+        }
+    }
+    else if (que->overwrite() || que->retain())
+    {
+        // a lapped reader never releases its pool reference, and a retained message may be read again
+        // after every reader released it: lossy and retaining rings carry inline payloads only
+        if(CALLBACK)
+        {
+            CALLBACK->delivery_complete(ErrorCode::IPC_ERR_INVAL);
+        }
+        return false;
+    }
+    else if (auto desc = FRAGMENT->write(data,size,que->consumers());
+                !desc.length() || !que->push_wait([&]
+                {
+                    // the header still travels in the ring slot, next to the descriptor
+                    return que->push_inline(desc, nullptr, 0, priority, header, [&](std::uint32_t ticket)
+                    {
+                        // readers came or went since the count was taken, count again for the ticket at hand
+                        if (que->roster() != roster)
+                        {
+                            FRAGMENT->commit(desc, que->consumers(priority, ticket));
+                        }
+                    });
+                }, tm))
     {
+        FRAGMENT->discard(desc);
+        if (impl_->reap())
+        {
+            // a reader that died without disconnecting held the ring or the pool, they have room now
+            return send(header, data, size, tm, priority);
+        }
         if(CALLBACK)
         {
             CALLBACK->delivery_complete(ErrorCode::IPC_ERR_INVAL);
@@ -278,10 +501,9 @@ bool Ipc<Wr>::write(void const *data, std::size_t size)
         return false;
     }
     
-    auto ret = Wr::is_broadcast ? 
-        HANDLE->waiter()->broadcast() : HANDLE->waiter()->notify();
+    Wr::is_broadcast ? HANDLE->waiter()->broadcast() : HANDLE->waiter()->notify();
 
-    if(!ret || CALLBACK)
+    if(CALLBACK)
     {
         CALLBACK->delivery_complete();
     }
@@ -290,22 +512,274 @@ bool Ipc<Wr>::write(void const *data, std::size_t size)
 }
 
 template <typename Wr>
-bool Ipc<Wr>::write(Buffer const & buff)
+bool Ipc<Wr>::write_batch(Buffer const * buffs, std::size_t count, std::uint32_t priority)
 {
-    return this->write(buff.data(), buff.size());
+    if (!valid() || buffs == nullptr || count == 0)
+    {
+        if(CALLBACK)
+        {
+            CALLBACK->delivery_complete(ErrorCode::IPC_ERR_NOINIT);
+        }
+        return false;
+    }
+    auto que = HANDLE->queue();
+    if (que == nullptr || que->segment() == nullptr || !que->connect() ||
+            !(que->segment()->connections()) || count > que->capacity() || priority >= que->priorities())
+    {
+        if(CALLBACK)
+        {
+            CALLBACK->delivery_complete(ErrorCode::IPC_ERR_NOMEM);
+        }
+        return false;
+    }
+
+    std::vector<Descriptor> descs;
+    descs.reserve(count);
+    auto const roster = que->roster();
+    auto recv_count = que->consumers();
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (buffs[i].empty())
+        {
+            break;
+        }
+        if (buffs[i].size() <= que->inline_size())
+        {
+            descs.push_back(Descriptor{0, 0, static_cast<std::uint32_t>(buffs[i].size())});
+            continue;
+        }
+        if (que->overwrite() || que->retain())
+        {
+            break;
+        }
+        descs.push_back(FRAGMENT->write(buffs[i].data(), buffs[i].size(), recv_count));
+        if (!descs.back().length())
+        {
+            break;
+        }
+    }
+
+    if (descs.size() != count || !descs.back().length() ||
+            !que->push_n(descs.data(), static_cast<std::uint32_t>(count), [&](std::uint32_t i, void *extra)
+            {
+                if (descs[i].is_inline())
+                {
+                    std::memcpy(extra, buffs[i].data(), buffs[i].size());
+                }
+            }, priority, [&](std::uint32_t i, std::uint32_t ticket)
+            {
+                // readers came or went since the count was taken, count again for the ticket at hand
+                if (!descs[i].is_inline() && (que->roster() != roster))
+                {
+                    FRAGMENT->commit(descs[i], que->consumers(priority, ticket));
+                }
+            }))
+    {
+        for (auto const &desc : descs)
+        {
+            FRAGMENT->discard(desc);
+        }
+        if (impl_->reap())
+        {
+            return write_batch(buffs, count, priority);
+        }
+        if(CALLBACK)
+        {
+            CALLBACK->delivery_complete(ErrorCode::IPC_ERR_INVAL);
+        }
+        return false;
+    }
+
+    Wr::is_broadcast ? HANDLE->waiter()->broadcast() : HANDLE->waiter()->notify();
+
+    if(CALLBACK)
+    {
+        CALLBACK->delivery_complete();
+    }
+
+    return true;
 }
 
 template <typename Wr>
-bool Ipc<Wr>::write(std::string const & str)
+bool Ipc<Wr>::stage(void const *data, std::size_t size)
 {
-    return this->write(str.c_str(), str.size());
+    if (!valid() || data == nullptr || size == 0)
+    {
+        return false;
+    }
+    auto const *p = static_cast<char const *>(data);
+    STAGED.emplace_back(p, p + size);
+    return true;
 }
 
-static std::string thread_id_to_string(const std::thread::id &id)
+template <typename Wr>
+bool Ipc<Wr>::publish(std::uint32_t priority)
+{
+    auto staged = std::move(STAGED);
+    STAGED.clear();
+    std::vector<Buffer> buffs;
+    buffs.reserve(staged.size());
+    for (auto &msg : staged)
+    {
+        buffs.emplace_back(msg.data(), msg.size());
+    }
+    return write_batch(buffs.data(), buffs.size(), priority);
+}
+
+template <typename Wr>
+void Ipc<Wr>::unstage()
+{
+    STAGED.clear();
+}
+
+template <typename Wr>
+Buffer Ipc<Wr>::loan(std::size_t size)
 {
-    std::ostringstream oss;
-    oss << id;
-    return oss.str();
+    if (!valid() || !CONNECTED || !(MODE & SENDER) || size == 0)
+    {
+        return {};
+    }
+    auto que = HANDLE->queue();
+    // lossy and retaining rings carry inline payloads only
+    if (que == nullptr || que->overwrite() || que->retain())
+    {
+        return {};
+    }
+    void *data = nullptr;
+    auto desc = FRAGMENT->loan(size, data);
+    if (data == nullptr)
+    {
+        return impl_->reap() ? loan(size) : Buffer{};
+    }
+    LOANS.emplace_back(data, desc);
+    return Buffer(data, size);
+}
+
+template <typename Wr>
+bool Ipc<Wr>::commit(Buffer const &loan, std::uint32_t priority)
+{
+    auto it = std::find_if(LOANS.begin(), LOANS.end(), [&loan](auto const &l) { return l.first == loan.data(); });
+    if (!valid() || it == LOANS.end())
+    {
+        if(CALLBACK)
+        {
+            CALLBACK->delivery_complete(ErrorCode::IPC_ERR_NOINIT);
+        }
+        return false;
+    }
+    auto que = HANDLE->queue();
+    if (que == nullptr || que->segment() == nullptr || !que->connect() ||
+            !(que->segment()->connections()) || priority >= que->priorities())
+    {
+        if(CALLBACK)
+        {
+            CALLBACK->delivery_complete(ErrorCode::IPC_ERR_NOMEM);
+        }
+        return false;
+    }
+
+    // the readers take over the reference of the loan before they can see the descriptor
+    auto const desc = it->second;
+    auto const roster = que->roster();
+    FRAGMENT->commit(desc, que->consumers());
+    if (!que->push_inline(desc, nullptr, 0, priority, nullptr, [&](std::uint32_t ticket)
+        {
+            if (que->roster() != roster)
+            {
+                FRAGMENT->commit(desc, que->consumers(priority, ticket));
+            }
+        }))
+    {
+        FRAGMENT->commit(desc, 1);
+        if (impl_->reap())
+        {
+            return commit(loan, priority);
+        }
+        if(CALLBACK)
+        {
+            CALLBACK->delivery_complete(ErrorCode::IPC_ERR_INVAL);
+        }
+        return false;
+    }
+    LOANS.erase(it);
+
+    Wr::is_broadcast ? HANDLE->waiter()->broadcast() : HANDLE->waiter()->notify();
+
+    if(CALLBACK)
+    {
+        CALLBACK->delivery_complete();
+    }
+
+    return true;
+}
+
+template <typename Wr>
+void Ipc<Wr>::discard(Buffer const &loan)
+{
+    auto it = std::find_if(LOANS.begin(), LOANS.end(), [&loan](auto const &l) { return l.first == loan.data(); });
+    if (it == LOANS.end())
+    {
+        return;
+    }
+    FRAGMENT->discard(it->second);
+    LOANS.erase(it);
+}
+
+template <typename Wr>
+bool Ipc<Wr>::write_keyed(std::uint64_t key, void const *data, std::size_t size)
+{
+    if (!valid() || data == nullptr || size == 0)
+    {
+        if(CALLBACK)
+        {
+            CALLBACK->delivery_complete(ErrorCode::IPC_ERR_NOINIT);
+        }
+        return false;
+    }
+    auto que = HANDLE->queue();
+    if (que == nullptr || que->segment() == nullptr || !que->connect() || !(que->segment()->connections()))
+    {
+        if(CALLBACK)
+        {
+            CALLBACK->delivery_complete(ErrorCode::IPC_ERR_NOMEM);
+        }
+        return false;
+    }
+    if (!que->conflate())
+    {
+        return this->write(data, size);
+    }
+
+    // conflated payloads live in the ring slot, a replaced one never holds a pool reference
+    if (!que->push_keyed(key, Descriptor{0, 0, static_cast<std::uint32_t>(size)}, data, size))
+    {
+        if(CALLBACK)
+        {
+            CALLBACK->delivery_complete(ErrorCode::IPC_ERR_INVAL);
+        }
+        return false;
+    }
+
+    HANDLE->waiter()->notify();
+
+    if(CALLBACK)
+    {
+        CALLBACK->delivery_complete();
+    }
+
+    return true;
+}
+
+template <typename Wr>
+bool Ipc<Wr>::write(Buffer const & buff, std::uint32_t priority)
+{
+    return this->write(buff.data(), buff.size(), priority);
+}
+
+template <typename Wr>
+bool Ipc<Wr>::write(std::string const & str, std::uint32_t priority)
+{
+    return this->write(str.c_str(), str.size(), priority);
 }
 
 template <typename Wr>
@@ -345,16 +819,53 @@ void Ipc<Wr>::read(std::uint64_t tm)
 
         HANDLE->wait_for([&]
         {
-            Descriptor desc{};
+            std::lock_guard<std::mutex> guard {impl_->popping};
+            Descriptor descs[READ_BATCH_SIZE] {};
+            auto const header_size = que->header_size();
             while(!que->empty())
             {
-                if(!que->pop(desc,[&](bool) -> bool
+                auto skipped = que->skipped();
+                auto count = que->pop_n(descs, READ_BATCH_SIZE, [&](Descriptor const &desc, void const *extra) -> bool
                 {
+                    auto const sequence = que->sequence();
+                    auto const lost = que->lost();
+                    if (header_size)
+                    {
+                        // filtered out on the header alone, a pooled payload only loses the reference
+                        Buffer header(const_cast<void *>(que->header_of(extra)), header_size);
+                        if (!CALLBACK->message_filter(&header))
+                        {
+                            return desc.is_inline() || FRAGMENT->release(desc);
+                        }
+                        if (desc.is_inline())
+                        {
+                            Buffer buf(const_cast<void *>(extra), desc.length());
+                            CALLBACK->message_arrived(&header, &buf, sequence, lost);
+                            return true;
+                        }
+                        return FRAGMENT->read(desc,[&](const Buffer *buf) -> void
+                        {
+                            CALLBACK->message_arrived(&header, buf, sequence, lost);
+                        });
+                    }
+                    if (desc.is_inline())
+                    {
+                        Buffer buf(const_cast<void *>(extra), desc.length());
+                        CALLBACK->message_arrived(&buf, sequence, lost);
+                        return true;
+                    }
                     return FRAGMENT->read(desc,[&](const Buffer *buf) -> void
                     {
-                        CALLBACK->message_arrived(buf);
+                        CALLBACK->message_arrived(buf, sequence, lost);
                     });
-                }))
+                });
+                // a lapped reader stops its batch at the gap, so it is reported in place
+                if (auto lost = que->skipped() - skipped)
+                {
+                    CALLBACK->message_skipped(lost);
+                    continue;
+                }
+                if (!count)
                 {
                     return;
                 }
@@ -363,11 +874,38 @@ void Ipc<Wr>::read(std::uint64_t tm)
     }
 }
 
+template <typename Wr>
+Stats Ipc<Wr>::stats() const
+{
+    Stats st {};
+    if (!valid())
+    {
+        return st;
+    }
+    auto seg = HANDLE->queue()->segment();
+    if (seg == nullptr)
+    {
+        return st;
+    }
+    st.capacity = seg->capacity();
+    st.rd = seg->rd();
+    st.wr = seg->wr();
+    seg->for_each_reader([&st](std::uint32_t id, std::uint32_t cursor, std::uint32_t skipped)
+    {
+        auto lag = static_cast<std::int32_t>(st.wr - cursor);
+        st.readers.push_back({id, cursor, static_cast<std::uint32_t>((std::max)(lag, 0)), skipped});
+    });
+    return st;
+}
+
 // UNICAST 一个通道对应一个Read
 template struct Ipc<Wr<Transmission::UNICAST>>;
 
 // BROADCAST 一个通道对应多个Read
 template struct Ipc<Wr<Transmission::BROADCAST>>;
 
+// WORKQUEUE 一个通道对应多个Read, 每条消息只由其中一个读取
+template struct Ipc<Wr<Transmission::WORKQUEUE>>;
+
 
 } // namespace ipc
@@ -0,0 +1,162 @@
+#include <ipc/Latest.h>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+#include <Handle.h>
+#include <sync/SeqLock.h>
+
+using namespace ipc::detail;
+
+namespace ipc
+{
+
+namespace
+{
+    struct alignas(64) head_t
+    {
+        SeqLock lock_;
+        // Set once by the creator, later endpoints must agree on it.
+        std::atomic<std::uint32_t> size_;
+    };
+
+    inline void *data_of(head_t *head) noexcept
+    {
+        return head + 1;
+    }
+} // internal-linkage
+
+struct LatestBuffer::LatestImpl
+{
+    Handle handle;
+    head_t *head { nullptr };
+    std::size_t size { 0 };
+};
+
+LatestBuffer::LatestBuffer() noexcept = default;
+
+LatestBuffer::LatestBuffer(char const * name, std::size_t size)
+    : impl_ {std::make_unique<LatestImpl>()}
+{
+    connect(name, size);
+}
+
+LatestBuffer::LatestBuffer(LatestBuffer&& rhs) noexcept
+    : LatestBuffer{}
+{
+    impl_.swap(rhs.impl_);
+}
+
+LatestBuffer::~LatestBuffer()
+{
+    disconnect();
+}
+
+LatestBuffer& LatestBuffer::operator=(LatestBuffer rhs) noexcept
+{
+    impl_.swap(rhs.impl_);
+    return *this;
+}
+
+bool LatestBuffer::connect(char const * name, std::size_t size)
+{
+    if (!is_valid_string(name) || (size == 0) || (size > UINT32_MAX))
+    {
+        return false;
+    }
+    disconnect();
+    if (impl_ == nullptr)
+    {
+        impl_ = std::make_unique<LatestImpl>();
+    }
+
+    auto const shm_name = make_prefix("", {"latest_", name});
+    auto &handle = impl_->handle;
+    // Only the creator sizes the object, the others attach to it as it is:
+    // acquiring an existing value with another size would resize it under the other endpoints.
+    for (unsigned k = 0, n = 0; n < ATTACH_RETRY; ++n)
+    {
+        if (handle.acquire(shm_name.c_str(), sizeof(head_t) + size, ipc::detail::create))
+        {
+            impl_->head = static_cast<head_t *>(handle.get());
+            impl_->head->size_.store(static_cast<std::uint32_t>(size), std::memory_order_release);
+            impl_->size = size;
+            return true;
+        }
+        if (errno != EEXIST)
+        {
+            break;
+        }
+        if (handle.acquire(shm_name.c_str(), 0, ipc::detail::open))
+        {
+            auto head = static_cast<head_t *>(handle.get());
+            for (unsigned j = 0, m = 0; (head->size_.load(std::memory_order_acquire) == 0) && (m < ATTACH_RETRY); ++m)
+            {
+                yield(j); // the creator is still setting the head up
+            }
+            if ((head->size_.load(std::memory_order_acquire) != size) || (handle.size() < sizeof(head_t) + size))
+            {
+                break;
+            }
+            impl_->head = head;
+            impl_->size = size;
+            return true;
+        }
+        yield(k); // the creator has not sized the object yet, or it went away meanwhile
+    }
+    handle.release();
+    return false;
+}
+
+void LatestBuffer::disconnect()
+{
+    if (impl_ == nullptr || impl_->head == nullptr)
+    {
+        return;
+    }
+    impl_->head = nullptr;
+    impl_->size = 0;
+    impl_->handle.release();
+}
+
+bool LatestBuffer::valid() const noexcept
+{
+    return (impl_ != nullptr) && (impl_->head != nullptr);
+}
+
+std::size_t LatestBuffer::size() const noexcept
+{
+    return valid() ? impl_->size : 0;
+}
+
+bool LatestBuffer::write(void const * data, std::size_t size)
+{
+    if (!valid() || (data == nullptr) || (size != impl_->size))
+    {
+        return false;
+    }
+    auto head = impl_->head;
+    head->lock_.write([&] {
+        std::memcpy(data_of(head), data, size);
+    });
+    return true;
+}
+
+bool LatestBuffer::read(void * data, std::size_t size) const
+{
+    if (!valid() || (data == nullptr) || (size != impl_->size))
+    {
+        return false;
+    }
+    auto head = impl_->head;
+    auto seq = head->lock_.read([&] {
+        std::memcpy(data, data_of(head), size);
+    });
+    return seq != 0;
+}
+
+std::uint64_t LatestBuffer::version() const noexcept
+{
+    return valid() ? (impl_->head->lock_.sequence() / 2) : 0;
+}
+
+} // namespace ipc
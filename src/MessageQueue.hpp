@@ -14,9 +14,10 @@ template <typename Choose>
 class MessageQueue
 {
 public:
-    explicit MessageQueue(char const *prefix, char const *name)
+    explicit MessageQueue(char const *prefix, char const *name, Options const &options = {})
         : prefix_{make_string(prefix)}
         , name_{make_string(name)}
+        , options_{options}
     { 
     }
 
@@ -28,7 +29,7 @@ public:
     {
         if (!queue_.valid())
         {
-            if(!queue_.open(make_prefix(prefix_,{"_",this->name_}).c_str()))
+            if(!queue_.open(make_prefix(prefix_,{"_",this->name_}).c_str(), options_))
             {
                 return false;
             }
@@ -70,6 +71,7 @@ public:
 private:
     std::string prefix_;
     std::string name_;
+    Options options_;
     Queue<Descriptor, Choose> queue_;
 };
 
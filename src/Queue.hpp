@@ -4,16 +4,28 @@
 #include <type_traits>
 #include <tuple>
 #include <cassert>
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <algorithm>
+#include <vector>
 #include <Handle.h>
 #include <sync/RwLock.h>
 #include <Resource.hpp>
 #include <sync/Waiter.h>
+#include <core/Content.h>
 
 namespace ipc
 {
 namespace detail
 {
 
+// Name of overflow segment `gen` of a chained ring.
+inline std::string chain_name(std::string const &name, std::uint32_t gen)
+{
+    return make_prefix("", {"chain_", name, "_", std::to_string(gen)});
+}
+
 class QueueConn
 {
 public:
@@ -42,7 +54,7 @@ public:
         }
 
         connected_id_ = segment->connect(mode);
-        return {connected_id(), true, segment->rd()};
+        return {connected_id(), true, segment->cursor(connected_id_)};
     }
 
     template <typename Segment>
@@ -59,22 +71,53 @@ public:
 
 protected:
     template <typename Segment>
-    Segment *open(char const *name)
+    Segment *open(char const *name, Options const &options)
     {
-        if (!is_valid_string(name))
+        if (!is_valid_string(name) || !is_valid_options(options))
         {
             return nullptr;
         }
-        if (!handle_.acquire(name, sizeof(Segment)))
+        // Only the endpoint that creates the ring sizes it, everybody else attaches and adopts the settings
+        // of the creator, so a live segment is never resized under the other endpoints.
+        for (unsigned k = 0, n = 0; n < ATTACH_RETRY; ++n)
         {
-            return nullptr;
+            if (handle_.acquire(name, Segment::size_of(options), ipc::detail::create))
+            {
+                auto segment = static_cast<Segment *>(handle_.get());
+                segment->init(options);
+                return segment;
+            }
+            if (errno != EEXIST)
+            {
+                handle_.release();
+                return nullptr;
+            }
+            if (handle_.acquire(name, 0, ipc::detail::open))
+            {
+                return attach<Segment>();
+            }
+            yield(k); // the creator has not sized the object yet, or it went away meanwhile
         }
+        handle_.release();
+        return nullptr;
+    }
+
+    // Waits for the creator of the mapped segment to set its head up, and checks that what it set up
+    // is a ring this endpoint can use.
+    template <typename Segment>
+    Segment *attach()
+    {
         auto segment = static_cast<Segment *>(handle_.get());
-        if (segment == nullptr)
+        for (unsigned k = 0, n = 0; !segment->constructed() && (n < ATTACH_RETRY); ++n)
         {
+            yield(k);
+        }
+        if (!segment->constructed() || !is_valid_options(segment->options()) ||
+                (handle_.size() < Segment::size_of(segment->options())))
+        {
+            handle_.release();
             return nullptr;
         }
-        segment->init();
         return segment;
     }
 
@@ -95,27 +138,33 @@ public:
     using segment_t = Segment;
     QueueBase() = default;
 
-    explicit QueueBase(char const *name)
+    explicit QueueBase(char const *name, Options const &options = {})
         : QueueBase{}
     {
-        segment_ = QueueConn::template open<segment_t>(name);
+        open(name, options);
     }
 
     virtual ~QueueBase()
     {
-
-        if(handle_.ref() <= 1)
+        wr_.handle_.release();
+        rd_.handle_.release();
+        if(segment_ != nullptr && handle_.ref() <= 1)
         {
             segment_->waiter().close();
+            segment_->space().close();
+            drop_chain();
         }
         QueueConn::close();
     }
 
 public:
-    bool open(char const *name) noexcept
+    bool open(char const *name, Options const &options = {}) noexcept
     {
         QueueConn::close();
-        segment_ = QueueConn::template open<segment_t>(name);
+        wr_ = {};
+        rd_ = {};
+        name_ = make_string(name);
+        segment_ = QueueConn::template open<segment_t>(name, options);
         return segment_ != nullptr;
     }
 
@@ -124,13 +173,142 @@ public:
         return segment_;
     }
 
+    std::uint32_t capacity() const noexcept
+    {
+        return valid() ? segment_->capacity() : 0;
+    }
+
+    std::uint32_t inline_size() const noexcept
+    {
+        return valid() ? segment_->options().inline_size : 0;
+    }
+
+    std::uint32_t header_size() const noexcept
+    {
+        return valid() ? segment_->options().header_size : 0;
+    }
+
+    // User header of the slot whose inline payload area is `extra`, it follows that area.
+    void const *header_of(void const *extra) const noexcept
+    {
+        return static_cast<char const *>(extra) + inline_size();
+    }
+
+    std::uint32_t priorities() const noexcept
+    {
+        return valid() ? segment_->options().priorities : 0;
+    }
+
+    bool overwrite() const noexcept
+    {
+        return valid() && segment_->options().overwrite;
+    }
+
+    bool chained() const noexcept
+    {
+        return valid() && segment_->options().chained;
+    }
+
+    bool competing() const noexcept
+    {
+        return valid() && segment_->options().competing;
+    }
+
+    bool conflate() const noexcept
+    {
+        return valid() && segment_->options().conflate;
+    }
+
+    std::uint32_t retain() const noexcept
+    {
+        return valid() ? segment_->options().retain : 0;
+    }
+
+    // Readers each message is handed to, competing readers consume a message once between them.
+    // Without any reader a message is kept for the next one to come, it resumes where the last one stopped.
+    std::uint32_t consumers() noexcept
+    {
+        if (!valid())
+        {
+            return 0;
+        }
+        return competing() ? 1 : (std::max)(segment_->consumers(), 1u);
+    }
+
+    // Readers that get the message a writer took `ticket` of ring `prio` for, before it commits it.
+    // Unlike consumers() it leaves out readers that connected after the ticket was taken.
+    std::uint32_t consumers(std::uint32_t prio, std::uint32_t ticket) noexcept
+    {
+        if (!valid())
+        {
+            return 0;
+        }
+        return competing() ? 1 : (std::max)(segment_->consumers(prio, ticket), 1u);
+    }
+
+    // Changes whenever readers come, join a group or go.
+    std::uint32_t roster() const noexcept
+    {
+        return valid() ? segment_->roster() : 0;
+    }
+
+    // Whether nobody but this reader would read what it has not read yet, other readers keep the ring going.
+    bool orphans() noexcept
+    {
+        return valid() && connected_id() && segment_->orphans(connected_id());
+    }
+
+    // Joins consumer group `group` with this reader, the members of a group share its messages.
+    bool join(char const *group) noexcept
+    {
+        if (!valid() || !segment_->join(connected_id(), group))
+        {
+            return false;
+        }
+        for (std::uint32_t prio = 0; prio < MaxPriorities; ++prio)
+        {
+            cursors_[prio] = segment_->cursor(connected_id(), prio);
+        }
+        grouped_ = true;
+        return true;
+    }
+
+    // Generation of the sender slot this endpoint holds.
+    std::uint32_t epoch() const noexcept
+    {
+        return valid() ? segment_->epoch(connected_id()) : 0;
+    }
+
+    // Messages this reader lost to writers lapping it so far.
+    std::uint32_t skipped() const noexcept
+    {
+        return valid() ? segment_->skipped(connected_id()) : 0;
+    }
+
     bool connect(unsigned mode = RECEIVER) noexcept
     {
         auto tp = QueueConn::connect(segment_,mode);
         if (std::get<0>(tp) && std::get<1>(tp))
         {
-            cursor_ = std::get<2>(tp);
+            for (std::uint32_t prio = 0; prio < MaxPriorities; ++prio)
+            {
+                cursors_[prio] = segment_->cursor(connected_id(), prio);
+                if (!numbered_)
+                {
+                    // later connections keep counting, a reader that comes back behind its old cursor learns the gap
+                    tickets_[prio] = cursors_[prio];
+                    numbers_[prio] = shared_numbers() ? segment_->sequence(prio, cursors_[prio]) : cursors_[prio];
+                }
+            }
+            numbered_ = true;
+            rd_.segment_ = segment_;
+            rd_.id_ = connected_id();
             sender_flag_ = true;
+            if ((mode == RECEIVER) && chained())
+            {
+                // resume in the segment the previous reader stopped in
+                enter(segment_->head().load(std::memory_order_acquire));
+            }
             return true;
         }
         return std::get<0>(tp);
@@ -143,35 +321,188 @@ public:
             return false;
         }
 
+        if (rd_.gen_ != 0)
+        {
+            // the overflow segment stays for the next reader
+            rd_.segment_->disconnect(RECEIVER, rd_.id_);
+            rd_.handle_.release();
+        }
+        rd_ = {};
         segment_->disconnect(RECEIVER, std::exchange(connected_id_, 0));
         sender_flag_ = false;
+        grouped_ = false;
+        // the slowest reader may have gone, which frees slots for the writers
+        segment_->space_freed();
 
         return true;
     }
 
+    // Takes over reader connection `cc_id` claimed from a process that died, with the cursors it left,
+    // so it can be drained and closed like a connection of this endpoint. The reader of a chained ring
+    // holds another connection further down the chain, which is out of reach here.
+    bool adopt(std::uint32_t cc_id) noexcept
+    {
+        if (!valid() || connected_id() || chained())
+        {
+            return false;
+        }
+        connected_id_ = cc_id;
+        for (std::uint32_t prio = 0; prio < MaxPriorities; ++prio)
+        {
+            cursors_[prio] = segment_->cursor(cc_id, prio);
+            tickets_[prio] = cursors_[prio];
+            numbers_[prio] = shared_numbers() ? segment_->sequence(prio, cursors_[prio]) : cursors_[prio];
+        }
+        numbered_ = true;
+        rd_.segment_ = segment_;
+        rd_.id_ = cc_id;
+        sender_flag_ = true;
+        return true;
+    }
+
     bool valid() const noexcept
     {
         return segment_ != nullptr;
     }
 
+    // The write index is summed over the rings, so are the cursors.
+    // A sealed segment of a chained ring is never empty, the next pop moves on to the following one.
     bool empty() const noexcept
     {
-        return !valid() || (cursor_ == segment_->wr());
+        if (!valid())
+        {
+            return true;
+        }
+        cursor_t cur = 0;
+        for (auto c : cursors_)
+        {
+            cur += c;
+        }
+        return cur == ((rd_.segment_ != nullptr) ? rd_.segment_ : segment_)->wr();
     }
 
     template <typename Descriptor, typename... P>
-    bool push(P &&...params)
+    bool push(std::uint32_t prio, P &&...params)
     {
         if (segment_ == nullptr || sender_flag_ == false)
         {
             return false;
         }
-        return segment_->push(this, [&](void *p)
+        return write(prio, [&](segment_t *seg)
+        {
+            return seg->push(this, prio, [&](void *p, std::uint32_t)
+            {
+                ::new (p) Descriptor(std::forward<P>(params)...);
+                put_header(p, nullptr);
+            });
+        });
+    }
+
+    // Stores the payload in the slot right behind the descriptor, and the user header after it.
+    // `reserved` gets the ticket of the slot before the slot is committed.
+    template <typename Descriptor, typename R>
+    bool push_inline(Descriptor const &item, void const *data, std::size_t size, std::uint32_t prio,
+                     void const *header, R &&reserved)
+    {
+        if (segment_ == nullptr || sender_flag_ == false || size > inline_size())
+        {
+            return false;
+        }
+        return write(prio, [&](segment_t *seg)
+        {
+            return seg->push(this, prio, [&](void *p, std::uint32_t ticket)
+            {
+                ::new (p) Descriptor(item);
+                if (size)
+                {
+                    std::memcpy(segment_t::extra(p), data, size);
+                }
+                put_header(p, header);
+                reserved(ticket);
+            });
+        });
+    }
+
+    // Queues under `key` on a conflating ring, replacing the message of that key the reader did not take yet.
+    template <typename Descriptor>
+    bool push_keyed(std::uint64_t key, Descriptor const &item, void const *data, std::size_t size)
+    {
+        if (segment_ == nullptr || sender_flag_ == false || size > inline_size())
+        {
+            return false;
+        }
+        return segment_->push_keyed(this, 0, key, [&](void *p)
+        {
+            ::new (p) Descriptor(item);
+            if (size)
+            {
+                std::memcpy(segment_t::extra(p), data, size);
+            }
+            put_header(p, nullptr);
+        });
+    }
+
+    // `fill` may store an inline payload for item i into the slot area it is given,
+    // `reserved` gets i and the ticket of its slot. Both run before the set is committed.
+    template <typename Descriptor, typename F, typename R>
+    bool push_n(Descriptor const *items, std::uint32_t count, F &&fill, std::uint32_t prio, R &&reserved)
+    {
+        if (segment_ == nullptr || sender_flag_ == false || items == nullptr)
+        {
+            return false;
+        }
+        if (count > capacity())
+        {
+            return false;
+        }
+        return write(prio, [&](segment_t *seg)
         {
-            ::new (p) Descriptor(std::forward<P>(params)...);
+            return seg->push_n(this, prio, count, [this, items, &fill, &reserved](std::uint32_t i, void *p, std::uint32_t ticket)
+            {
+                ::new (p) Descriptor(items[i]);
+                put_header(p, nullptr);
+                fill(i, segment_t::extra(p));
+                reserved(i, ticket);
+            });
         });
     }
 
+    // Retries `push` until it succeeds or `tm` ms have passed, parking on the space waiter
+    // of the segment in between. A zero timeout tries once, INVALID_TIMEOUT waits forever.
+    // Readers signal the space waiter whenever they move on or leave, so a parked writer
+    // sleeps until then and does not poll.
+    template <typename F>
+    bool push_wait(F &&push, std::uint64_t tm)
+    {
+        bool done = push();
+        if (done || !tm || segment_ == nullptr)
+        {
+            return done;
+        }
+        using namespace std::chrono;
+        bool const forever = (tm == static_cast<std::uint64_t>(TimeOut::INVALID_TIMEOUT));
+        auto const deadline = steady_clock::now() + milliseconds(forever ? 0 : tm);
+        while (!done)
+        {
+            auto left = tm;
+            if (!forever)
+            {
+                auto now = steady_clock::now();
+                if (now >= deadline)
+                {
+                    return false;
+                }
+                left = static_cast<std::uint64_t>(ceil<milliseconds>(deadline - now).count());
+            }
+            segment_->wait_space([&]
+            {
+                return !(done = push());
+            }, left);
+        }
+        return true;
+    }
+
+    // Takes the oldest item of the highest priority class that has one.
     template <typename Descriptor, typename F>
     bool pop(Descriptor &item, F &&out)
     {
@@ -179,10 +510,114 @@ public:
         {
             return false;
         }
-        return segment_->pop(this, cursor_, [&item](void *p)
+        do
+        {
+            for (auto prio = priorities(); prio-- > 0;)
+            {
+                if (rd_.segment_->pop(&rd_, prio, cursors_[prio], [&item](void *p)
+                {
+                    ::new (&item) Descriptor(std::move(*static_cast<Descriptor *>(p)));
+                }, out))
+                {
+                    segment_->space_freed();
+                    return true;
+                }
+            }
+        } while (follow());
+        return false;
+    }
+
+    // Returns the number of descriptors moved into items, `out` is invoked for each of them in order
+    // together with the inline payload area of its slot, which stays valid until `out` returns.
+    // On a lossy ring the slot may be rewritten any time, and competing readers hand a slot back
+    // before processing it, so the inline payload and the user header are copied out first.
+    // Higher priority classes are drained first, every call starts over with the highest one.
+    // sequence() and lost() tell about the item `out` is invoked for.
+    template <typename Descriptor, typename F>
+    std::uint32_t pop_n(Descriptor *items, std::uint32_t count, F &&out)
+    {
+        if (segment_ == nullptr || sender_flag_ == false || items == nullptr)
+        {
+            return 0;
+        }
+        bool const copy = overwrite() || competing() || grouped_;
+        if (copy)
+        {
+            scratch_.resize(inline_size() + header_size());
+        }
+        void *extra = nullptr;
+        std::uint32_t ticket = 0;
+        std::uint32_t n = 0;
+        for (auto prio = priorities(); (prio-- > 0) && (n < count);)
+        {
+            auto *base = items + n;
+            n += rd_.segment_->pop_n(&rd_, prio, cursors_[prio], count - n, [this, base, copy, &extra, &ticket](std::uint32_t i, void *p, std::uint32_t t)
+            {
+                ticket = t;
+                ::new (base + i) Descriptor(std::move(*static_cast<Descriptor *>(p)));
+                extra = segment_t::extra(p);
+                if (copy)
+                {
+                    std::memcpy(scratch_.data(), extra, scratch_.size());
+                    extra = scratch_.data();
+                }
+            }, [this, prio, base, &extra, &ticket, &out](std::uint32_t i) -> bool
+            {
+                number(prio, ticket);
+                return out(base[i], static_cast<void const *>(extra));
+            });
+            if (!n && !prio && follow())
+            {
+                prio = priorities(); // continue in the next segment of the chain
+            }
+        }
+        if (n)
+        {
+            segment_->space_freed();
+        }
+        return n;
+    }
+
+    // Makes the message with sequence number `sequence` the next one this reader takes,
+    // it must still be retained by the ring, or be the next one to be written.
+    bool seek(std::uint64_t sequence) noexcept
+    {
+        if (!valid() || !connected_id() || (segment_->sequence(0, static_cast<cursor_t>(sequence)) != sequence) ||
+                !segment_->seek(connected_id(), 0, static_cast<cursor_t>(sequence)))
+        {
+            return false;
+        }
+        cursors_[0] = static_cast<cursor_t>(sequence);
+        tickets_[0] = cursors_[0];
+        numbers_[0] = sequence;
+        return true;
+    }
+
+    // Steps this reader `count` messages back from where it stands.
+    bool rewind(std::uint64_t count) noexcept
+    {
+        if (!valid())
         {
-            ::new (&item) Descriptor(std::move(*static_cast<Descriptor *>(p)));
-        }, std::forward<F>(out));
+            return false;
+        }
+        auto const next = segment_->sequence(0, cursors_[0]);
+        return (count <= next) && seek(next - count);
+    }
+
+    // 64-bit sequence number of the item handed out last, counted per priority class. The segment extends
+    // the ring tickets the same way for every reader, so they all see the same number for a message,
+    // across ticket wraps too. Lanes and chained rings have one reader, which counts what it took.
+    std::uint64_t sequence() const noexcept
+    {
+        return sequence_;
+    }
+
+    // Messages of its class this reader missed right before the item handed out last,
+    // because a writer lapped it or it reconnected behind the other readers.
+    // Competing and grouped readers skip what the others took, which is not lost.
+    std::uint64_t lost() const noexcept
+    {
+        return lost_;
     }
 
     inline Waiter *waiter() noexcept
@@ -191,10 +626,290 @@ public:
     }
 
 private:
-    // It is used to record the actual read subscript of the object currently being read.
-    decltype(std::declval<segment_t>().rd()) cursor_ = 0;
+    // Whether the segment numbers the messages, rather than the only reader of lanes or a chained ring.
+    bool shared_numbers() const noexcept
+    {
+        return !(segment_->options().lanes || segment_->options().chained);
+    }
+
+    // Numbers the item of ring `prio` with `ticket`, the numbers skipped since the last one count as lost.
+    void number(std::uint32_t prio, std::uint32_t ticket) noexcept
+    {
+        if (shared_numbers())
+        {
+            sequence_ = segment_->sequence(prio, ticket);
+        }
+        else
+        {
+            sequence_ = numbers_[prio] + static_cast<std::uint32_t>((std::max)(static_cast<std::int32_t>(ticket - tickets_[prio]), 0));
+        }
+        auto const gap = (sequence_ > numbers_[prio]) ? sequence_ - numbers_[prio] : 0;
+        lost_ = (competing() || grouped_) ? 0 : gap;
+        numbers_[prio] = sequence_ + 1;
+        tickets_[prio] = ticket + 1;
+    }
+
+    // Fills the user header of the slot holding the descriptor at `p`, a missing header is zeroed
+    // so readers never filter on what an earlier message left there.
+    void put_header(void *p, void const *header) noexcept
+    {
+        auto const size = header_size();
+        if (size == 0)
+        {
+            return;
+        }
+        auto *dst = static_cast<char *>(segment_t::extra(p)) + inline_size();
+        if (header != nullptr)
+        {
+            std::memcpy(dst, header, size);
+        }
+        else
+        {
+            std::memset(dst, 0, size);
+        }
+    }
+
+    // A segment of a chained ring as mapped by this endpoint, together with the connection held in it.
+    // Unchained queues only ever use their own segment here.
+    struct link_t
+    {
+        std::uint32_t gen_ = 0;
+        std::uint32_t id_ = 0;
+        segment_t *segment_ = nullptr;
+        Handle handle_;
+
+        link_t() = default;
+        link_t(link_t &&) = default;
+        link_t &operator=(link_t &&rhs) noexcept
+        {
+            gen_ = rhs.gen_;
+            id_ = rhs.id_;
+            segment_ = rhs.segment_;
+            handle_.release();
+            handle_ = std::move(rhs.handle_);
+            return *this;
+        }
+
+        uint32_t connected_id() const noexcept
+        {
+            return id_;
+        }
+    };
+
+    // Maps generation `gen` of the chain, the first one is the segment of the queue itself.
+    bool map(link_t &link, std::uint32_t gen)
+    {
+        if ((link.segment_ != nullptr) && (link.gen_ == gen))
+        {
+            return true;
+        }
+        link = {};
+        link.gen_ = gen;
+        if (gen == 0)
+        {
+            link.segment_ = segment_;
+            return true;
+        }
+        if (!link.handle_.acquire(chain_name(name_, gen).c_str(), 0, ipc::detail::open) || (link.handle_.get() == nullptr))
+        {
+            link = {};
+            return false;
+        }
+        link.segment_ = static_cast<segment_t *>(link.handle_.get());
+        return true;
+    }
+
+    // Runs `push` against the segment the writers fill. A full segment of a chained ring is sealed
+    // and linked to a new one, and the writers return to the first segment once the reader left it.
+    template <typename F>
+    bool write(std::uint32_t prio, F &&push)
+    {
+        if (prio >= priorities())
+        {
+            return false;
+        }
+        if (!chained())
+        {
+            return push(segment_);
+        }
+        for (;;)
+        {
+            auto gen = segment_->tail().load(std::memory_order_acquire);
+            if (!map(wr_, gen))
+            {
+                if (segment_->tail().load(std::memory_order_acquire) != gen)
+                {
+                    continue; // drained and gone meanwhile
+                }
+                return false;
+            }
+            if ((gen != 0) && segment_->vacant().load(std::memory_order_acquire))
+            {
+                rewind();
+                continue;
+            }
+            if (push(wr_.segment_))
+            {
+                return true;
+            }
+            if (!grow())
+            {
+                return false;
+            }
+        }
+    }
+
+    // Links the full segment at the tail of the chain to a new overflow segment.
+    bool grow()
+    {
+        auto guard = std::unique_lock(segment_->chain_lock());
+        if (segment_->tail().load(std::memory_order_relaxed) != wr_.gen_)
+        {
+            return true; // another writer grew the chain meanwhile
+        }
+        auto const &options = segment_->options();
+        link_t link;
+        for (unsigned n = 0; (link.segment_ == nullptr) && (n < ATTACH_RETRY); ++n)
+        {
+            // a name may still be taken by a chain a crashed process left behind
+            link.gen_ = segment_->generate();
+            if (link.handle_.acquire(chain_name(name_, link.gen_).c_str(), segment_t::size_of(options), ipc::detail::create))
+            {
+                link.segment_ = static_cast<segment_t *>(link.handle_.get());
+            }
+        }
+        if (link.segment_ == nullptr)
+        {
+            return false;
+        }
+        link.segment_->init(options);
+        // held on behalf of the reader, which drops it once it drained the segment
+        link.handle_.add_ref();
+        wr_.segment_->link(link.gen_);
+        segment_->tail().store(link.gen_, std::memory_order_release);
+        wr_ = std::move(link);
+        return true;
+    }
+
+    // Ends the overflow segment at the tail of the chain and lets the writers continue in the first one.
+    void rewind()
+    {
+        auto guard = std::unique_lock(segment_->chain_lock());
+        if ((segment_->tail().load(std::memory_order_relaxed) != wr_.gen_) ||
+                !segment_->vacant().load(std::memory_order_relaxed))
+        {
+            return;
+        }
+        // the old link of the first segment must be gone before the reader can get back to it
+        segment_->vacant().store(false, std::memory_order_relaxed);
+        segment_->relink();
+        wr_.segment_->link(0);
+        segment_->tail().store(0, std::memory_order_release);
+    }
+
+    // Takes the reader to generation `gen` of the chain.
+    bool enter(std::uint32_t gen)
+    {
+        link_t link;
+        if (!map(link, gen))
+        {
+            return false;
+        }
+        link.id_ = (gen == 0) ? connected_id() : link.segment_->connect(RECEIVER);
+        if (!link.id_)
+        {
+            return false;
+        }
+        cursors_[0] = link.segment_->cursor(link.id_);
+        // tickets start over in every segment of the chain, a chained ring loses nothing on the way
+        tickets_[0] = cursors_[0];
+        if (rd_.gen_ != 0)
+        {
+            rd_.segment_->disconnect(RECEIVER, rd_.id_);
+        }
+        rd_ = std::move(link);
+        segment_->head().store(gen, std::memory_order_release);
+        return true;
+    }
+
+    // Moves the reader on once it drained a sealed segment of a chained ring.
+    bool follow()
+    {
+        if (!chained() || !rd_.segment_->drained(cursors_[0]))
+        {
+            return false;
+        }
+        auto const gen = rd_.gen_;
+        Handle done;
+        if (gen != 0)
+        {
+            done = std::move(rd_.handle_);
+        }
+        if (!enter(rd_.segment_->next() - 1))
+        {
+            if (gen != 0)
+            {
+                rd_.handle_ = std::move(done);
+            }
+            return false;
+        }
+        if (gen == 0)
+        {
+            segment_->vacant().store(true, std::memory_order_release);
+        }
+        else
+        {
+            // drained for good, drop the reference its creator took for the reader
+            done.sub_ref();
+        }
+        return true;
+    }
+
+    // Releases the overflow segments nobody is going to read any more, run by the last endpoint.
+    void drop_chain()
+    {
+        if (!segment_->options().chained)
+        {
+            return;
+        }
+        auto gen = segment_->head().load(std::memory_order_acquire);
+        if (gen == 0)
+        {
+            gen = segment_->next() ? (segment_->next() - 1) : 0;
+        }
+        while (gen != 0)
+        {
+            Handle handle;
+            if (!handle.acquire(chain_name(name_, gen).c_str(), 0, ipc::detail::open) || (handle.get() == nullptr))
+            {
+                break;
+            }
+            auto next = static_cast<segment_t *>(handle.get())->next();
+            handle.sub_ref();
+            gen = next ? (next - 1) : 0;
+        }
+    }
+
+private:
+    using cursor_t = decltype(std::declval<segment_t>().rd());
+    // It is used to record the actual read subscript of the object currently being read, per ring.
+    cursor_t cursors_[MaxPriorities] {};
     bool sender_flag_ = false;
+    // next sequence number of every ring, kept across reconnects, and the ticket it belongs to for lanes and chained rings
+    std::uint64_t numbers_[MaxPriorities] {};
+    cursor_t tickets_[MaxPriorities] {};
+    bool numbered_ = false;
+    std::uint64_t sequence_ = 0;
+    std::uint64_t lost_ = 0;
+    // member of a consumer group, which may reuse a slot before it is processed
+    bool grouped_ = false;
     segment_t *segment_ = nullptr;
+    // inline payload copied out of a lossy ring
+    std::vector<char> scratch_;
+    std::string name_;
+    // segments of a chained ring this endpoint writes to and reads from
+    link_t wr_;
+    link_t rd_;
 };
 
 } // namespace detail
@@ -208,7 +923,49 @@ public:
     template <typename... P>
     bool push(P &&...params)
     {
-        return base_t::template push<Descriptor>(std::forward<P>(params)...);
+        return base_t::template push<Descriptor>(0, std::forward<P>(params)...);
+    }
+
+    // Queues into the ring of priority class `prio`.
+    template <typename... P>
+    bool push_to(std::uint32_t prio, P &&...params)
+    {
+        return base_t::template push<Descriptor>(prio, std::forward<P>(params)...);
+    }
+
+    bool push_inline(Descriptor const &item, void const *data, std::size_t size, std::uint32_t prio = 0,
+                     void const *header = nullptr)
+    {
+        return base_t::push_inline(item, data, size, prio, header, [](std::uint32_t) {});
+    }
+
+    template <typename R>
+    bool push_inline(Descriptor const &item, void const *data, std::size_t size, std::uint32_t prio,
+                     void const *header, R &&reserved)
+    {
+        return base_t::push_inline(item, data, size, prio, header, std::forward<R>(reserved));
+    }
+
+    bool push_keyed(std::uint64_t key, Descriptor const &item, void const *data = nullptr, std::size_t size = 0)
+    {
+        return base_t::push_keyed(key, item, data, size);
+    }
+
+    template <typename F>
+    bool push_n(Descriptor const *items, std::uint32_t count, F &&fill, std::uint32_t prio = 0)
+    {
+        return base_t::push_n(items, count, std::forward<F>(fill), prio, [](std::uint32_t, std::uint32_t) {});
+    }
+
+    template <typename F, typename R>
+    bool push_n(Descriptor const *items, std::uint32_t count, F &&fill, std::uint32_t prio, R &&reserved)
+    {
+        return base_t::push_n(items, count, std::forward<F>(fill), prio, std::forward<R>(reserved));
+    }
+
+    bool push_n(Descriptor const *items, std::uint32_t count)
+    {
+        return base_t::push_n(items, count, [](std::uint32_t, void *) {}, 0, [](std::uint32_t, std::uint32_t) {});
     }
 
     template <typename F>
@@ -216,6 +973,12 @@ public:
     {
         return base_t::pop(item, std::forward<F>(out));
     }
+
+    template <typename F>
+    std::uint32_t pop_n(Descriptor *items, std::uint32_t count, F &&out)
+    {
+        return base_t::pop_n(items, count, std::forward<F>(out));
+    }
 };
 
 } // namespace ipc
@@ -4,6 +4,7 @@
 #include <string>
 #include <system_error>
 #include <sys/time.h>
+#include <ipc/def.h>
 
 namespace ipc {
 
@@ -62,6 +63,52 @@ inline timespec make_timespec(std::uint64_t tm /*ms*/) noexcept(false)
     return ts;
 }
 
+// How often an endpoint yields while the creator of a segment it attached to still sets up its head.
+constexpr unsigned ATTACH_RETRY = 64;
+
+/**
+ * @brief Check that a ring capacity is a power of two inside the supported range.
+ * 
+ * @param capacity 
+ * @return true 
+ * @return false 
+ */
+constexpr bool is_valid_capacity(std::uint32_t capacity) noexcept
+{
+    return (capacity >= static_cast<std::uint32_t>(Capacity::MIN_CAPACITY)) &&
+           (capacity <= static_cast<std::uint32_t>(Capacity::MAX_CAPACITY)) &&
+           !(capacity & (capacity - 1));
+}
+
+/**
+ * @brief Check the settings of a channel.
+ * 
+ * @param options 
+ * @return true 
+ * @return false 
+ */
+constexpr bool is_valid_options(Options const &options) noexcept
+{
+    return is_valid_capacity(options.capacity) &&
+           (options.inline_size <= static_cast<std::uint32_t>(InlineSize::MAX_INLINE_SIZE)) &&
+           ((options.header_size == static_cast<std::uint32_t>(HeaderSize::DISABLED)) ||
+            ((options.header_size >= static_cast<std::uint32_t>(HeaderSize::MIN_HEADER_SIZE)) &&
+             (options.header_size <= static_cast<std::uint32_t>(HeaderSize::MAX_HEADER_SIZE)))) &&
+           (!options.overwrite || (options.inline_size && !options.lanes)) &&
+           (options.pool_size >= static_cast<std::uint32_t>(PoolSize::MIN_POOL_SIZE)) &&
+           (options.pool_size <= static_cast<std::uint32_t>(PoolSize::MAX_POOL_SIZE)) &&
+           (options.priorities >= 1) &&
+           (options.priorities <= static_cast<std::uint32_t>(Priority::MAX_PRIORITIES)) &&
+           (!options.lanes || (options.priorities == 1)) &&
+           (!options.chained || (!options.lanes && !options.overwrite && (options.priorities == 1))) &&
+           (!options.competing || (!options.lanes && !options.overwrite && !options.chained)) &&
+           (!options.conflate || (options.inline_size && !options.lanes && !options.overwrite &&
+                                  !options.chained && !options.competing && (options.priorities == 1))) &&
+           (!options.retain || ((options.retain < options.capacity) && options.inline_size && !options.lanes &&
+                                !options.overwrite && !options.chained && !options.competing && !options.conflate &&
+                                (options.priorities == 1)));
+}
+
 inline std::size_t align_size(const std::size_t &size, const std::size_t &align)
 {
     return (size + align - 1) & ~(align - 1);
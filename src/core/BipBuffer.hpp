@@ -0,0 +1,157 @@
+#ifndef _IPC_CORE_BIPBUFFER_H_
+#define _IPC_CORE_BIPBUFFER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace ipc
+{
+namespace detail
+{
+
+////////////////////////////////////////////////////////////////
+/// FIFO allocator over a block of shared memory.
+/// Blocks are carved one behind the other from a ring, a block that no
+/// longer fits in front of the end is placed at the start once the oldest
+/// blocks there are gone. Payloads of one sender are given up roughly in
+/// the order they were written, so reclaiming only ever advances the tail
+/// past the oldest blocks and both ends cost O(1) per message.
+/// Its state lives at the start of the block and, like Slab, only the
+/// sender owning the pool touches it.
+////////////////////////////////////////////////////////////////
+
+class BipBuffer
+{
+public:
+    // Blocks are aligned to this, the end of the ring too, so a skip mark always fits in front of it.
+    static constexpr std::size_t Align = 16;
+
+    BipBuffer(void *base, std::size_t size) noexcept
+        : head_{static_cast<head_t *>(base)}
+        , base_{static_cast<char *>(base)}
+        , begin_{align(sizeof(head_t))}
+        , end_{static_cast<std::uint32_t>(size & ~(Align - 1))}
+    {
+        // a pool belongs to one sender slot and epoch, so a new owner always starts from scratch
+        std::memset(head_, 0, sizeof(head_t));
+        head_->head_ = head_->tail_ = begin_;
+    }
+
+    BipBuffer(BipBuffer const &) = delete;
+    BipBuffer &operator=(BipBuffer const &) = delete;
+
+public:
+    // Returns the `size` bytes behind the block header, or nullptr while the oldest blocks still hold the room.
+    void *allocate(std::size_t size) noexcept
+    {
+        if (size > end_ - begin_)
+        {
+            return nullptr;
+        }
+        auto const block = static_cast<std::uint32_t>(align(sizeof(block_t) + size));
+        if (!head_->used_)
+        {
+            head_->head_ = head_->tail_ = begin_;
+        }
+        auto pos = head_->head_;
+        if (head_->used_ && (pos == head_->tail_))
+        {
+            return nullptr;
+        }
+        if (pos >= head_->tail_)
+        {
+            if (block > end_ - pos)
+            {
+                // the rest in front of the end is skipped, the block goes to the start if the tail has left room
+                if (block > head_->tail_ - begin_)
+                {
+                    return nullptr;
+                }
+                mark(pos, (end_ - pos) | Skip);
+                head_->used_ += end_ - pos;
+                pos = begin_;
+            }
+        }
+        else if (block > head_->tail_ - pos)
+        {
+            return nullptr;
+        }
+        mark(pos, block);
+        head_->used_ += block;
+        head_->head_ = (pos + block == end_) ? begin_ : pos + block;
+        return base_ + pos + sizeof(block_t);
+    }
+
+    // Advances the tail past the oldest blocks as long as `done(data)` says they can go,
+    // `data` being what allocate returned for them.
+    template <typename F>
+    void reclaim(F &&done)
+    {
+        while (head_->used_)
+        {
+            auto const pos = head_->tail_;
+            auto const *b = block_at(pos);
+            if (!(b->size_ & Skip) && !done(base_ + pos + sizeof(block_t)))
+            {
+                break;
+            }
+            auto const size = b->size_ & ~Skip;
+            head_->used_ -= size;
+            head_->tail_ = (pos + size == end_) ? begin_ : pos + size;
+        }
+    }
+
+    // Bytes between tail and head, skipped ones included.
+    std::size_t used() const noexcept
+    {
+        return static_cast<std::size_t>(head_->used_);
+    }
+
+    std::size_t capacity() const noexcept
+    {
+        return end_ - begin_;
+    }
+
+private:
+    struct alignas(64) head_t
+    {
+        std::uint32_t head_;
+        std::uint32_t tail_;
+        std::uint64_t used_;
+    };
+
+    struct block_t
+    {
+        std::uint32_t size_;
+    };
+
+    // marks the filler between the last block and the end of the ring, pools stay well below 2 GiB
+    static constexpr std::uint32_t Skip = std::uint32_t{1} << 31;
+
+    static constexpr std::uint32_t align(std::size_t size) noexcept
+    {
+        return static_cast<std::uint32_t>((size + Align - 1) & ~(Align - 1));
+    }
+
+    block_t *block_at(std::uint32_t pos) const noexcept
+    {
+        return reinterpret_cast<block_t *>(base_ + pos);
+    }
+
+    void mark(std::uint32_t pos, std::uint32_t size) noexcept
+    {
+        block_at(pos)->size_ = size;
+    }
+
+private:
+    head_t *head_;
+    char *base_;
+    std::uint32_t begin_;
+    std::uint32_t end_;
+};
+
+} // namespace detail
+} // namespace ipc
+
+#endif // ! _IPC_CORE_BIPBUFFER_H_
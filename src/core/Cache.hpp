@@ -2,16 +2,22 @@
 #define _IPC_CORE_Cache_H_
 
 #include <config.h>
-#include <thread>
-#include <sstream>
+#include <array>
+#include <cstring>
+#include <string>
 #include <memory>
+#include <mutex>
 #include <functional>
 #include <iostream>
+#include <deque>
 #include <unordered_map>
-#include <memory_resource>
 #include <ipc/def.h>
+#include <ipc/Buffer.h>
 #include <sync/RwLock.h>
+#include <Descriptor.h>
 #include <Handle.h>
+#include <core/Slab.hpp>
+#include <core/BipBuffer.hpp>
 
 namespace ipc
 {
@@ -19,19 +25,45 @@ namespace detail
 {
 
 static constexpr uint32_t DEFAULT_WRITE_CNT = 1;
-static constexpr std::size_t DEFAULT_CACHE_SIZE = 1024 * 1024 * 1024; // 1G
-static const std::string DEFAULT_SHM_NAME = "tiny_ipc_";
-static constexpr uint32_t DEFAULT_TIMEOUT_VALUE = 10 * 1000; // mill
+// The first extent of a payload pool, every further one is twice the size of the one before.
+static constexpr std::size_t DEFAULT_EXTENT_SIZE = 1024 * 1024; // 1M
+// Enough to cover PoolSize::MAX_POOL_SIZE.
+static constexpr uint32_t MAX_EXTENTS = 12;
+// In-flight payloads a write looks at, more than the one it adds so the sweep keeps moving through the backlog.
+static constexpr std::size_t RECLAIM_BATCH = 4;
 
 // Unified release after the application ends
 static std::unordered_map<std::string, std::shared_ptr<SpinLock>> locks;
-    
 
-static std::string thread_id_to_string(const std::thread::id &id)
+// Payload pool of the sender holding a connection slot of a channel,
+// the slot epoch keeps a reused slot from opening the pool of its previous owner.
+// Extents after the first one are named after their index.
+inline std::string pool_name(const std::string &channel, const uint32_t &producer, const uint32_t &epoch,
+                             const uint32_t &extent = 0)
 {
-    std::ostringstream oss;
-    oss << id;
-    return oss.str();
+    if (extent)
+    {
+        return make_prefix("", {"pool_", channel, "_", std::to_string(producer), "_", std::to_string(epoch), "_",
+                                std::to_string(extent)});
+    }
+    return make_prefix("", {"pool_", channel, "_", std::to_string(producer), "_", std::to_string(epoch)});
+}
+
+// Descriptor offsets run through the extents of a pool one after the other,
+// so the extent of a payload follows from its offset alone.
+inline std::size_t extent_start(const uint32_t &extent)
+{
+    return DEFAULT_EXTENT_SIZE * ((std::size_t{1} << extent) - 1);
+}
+
+inline uint32_t extent_of(const uint32_t &offset)
+{
+    uint32_t extent = 0;
+    while ((extent + 1 < MAX_EXTENTS) && (offset >= extent_start(extent + 1)))
+    {
+        ++extent;
+    }
+    return extent;
 }
 
 class CacheBase
@@ -41,18 +73,43 @@ public:
     virtual ~CacheBase() = default;
 
 public:
-    virtual bool init() = 0;
+    // `producer` and `epoch` identify the connection slot of a sender, receivers pass 0.
+    virtual bool init(const std::string &channel, const uint32_t &producer, const uint32_t &epoch) = 0;
     // SENDER
     virtual Descriptor write(void const *data, const std::size_t &size,const uint32_t &cnt)
     {
         return {};
     }
 
+    // SENDER, room for a payload of `size` bytes the caller fills in place, `data` points at it.
+    // The loan holds the payload until commit() or discard()
+    virtual Descriptor loan(const std::size_t &size, void *&data)
+    {
+        data = nullptr;
+        return {};
+    }
+
+    // SENDER, hands a loaned payload over to `cnt` readers, right before its descriptor is queued
+    virtual void commit(const Descriptor &desc, const uint32_t &cnt)
+    {
+    }
+
+    // SENDER, gives back the payload of a descriptor that was never queued
+    virtual void discard(const Descriptor &desc)
+    {
+    }
+
     // RECEIVER
     virtual bool read(const Descriptor &desc, std::function<void(const Buffer *)> callbacK)
     {
         return {};
     }
+
+    // RECEIVER, gives up the reference to a payload without reading it
+    virtual bool release(const Descriptor &desc)
+    {
+        return {};
+    }
 };
 
 template<unsigned>
@@ -66,27 +123,36 @@ template<>
 class Cache<SENDER> : public CacheBase
 {
 public:
-    Cache<SENDER>()
+    // Payloads are carved from a ring reclaimed in write order instead of size classes with Options::fifo_pool,
+    // the pool is mapped in extents up to Options::pool_size.
+    explicit Cache<SENDER>(Options const &options = {})
         : CacheBase()
-        , id_{std::this_thread::get_id()}
-        , handle_ {}
-        , pool_ {nullptr}
+        , producer_{0}
+        , epoch_{0}
+        , channel_ {}
+        , extents_ {0}
+        , size_ {options.pool_size}
+        , handles_ {}
+        , pools_ {}
+        , fifos_ {}
+        , current_ {0}
+        , use_fifo_ {options.fifo_pool}
     {
         
     }
 
     virtual ~Cache<SENDER>()
     {
-        // free all apply memory
-        // There may be some memory that has not been read properly
-        for (auto &it : map_)
+        // free all apply memory, payloads still referenced included: the pool goes away with this sender,
+        // readers keep the extents they mapped until they are done with them
+        for (auto &it : inflight_)
         {
-            pool_->deallocate(it.first,std::get<0>(it.second));
+            deallocate(it.data, it.size);
         }
-        map_.clear();
+        inflight_.clear();
 
         // free lock
-        auto it = locks.find(std::string(handle_.name()));
+        auto it = locks.find(std::string(handles_[0].name()));
         if(it != locks.end())
         {
             locks.erase(it);
@@ -94,44 +160,75 @@ public:
     }
 
 public:
-    virtual bool init() final
+    virtual bool init(const std::string &channel, const uint32_t &producer, const uint32_t &epoch) final
     {
-        // Apply for shared memory space
-        auto name = DEFAULT_SHM_NAME + thread_id_to_string(id_);
-        if (!handle_.acquire(name.c_str(), DEFAULT_CACHE_SIZE))
+        if (!producer)
+        {
+            return false;
+        }
+        // payloads still tracked live in the pool of the previous slot, which the readers keep mapped
+        inflight_.clear();
+        for (uint32_t i = 0; i < extents_; ++i)
+        {
+            pools_[i].reset();
+            fifos_[i].reset();
+            handles_[i].release();
+        }
+        extents_ = 0;
+        current_ = 0;
+        producer_ = producer;
+        epoch_ = epoch;
+        channel_ = channel;
+        // Apply for shared memory space, the first extent right away
+        if (!grow())
         {
             return false;
         }
 
         // Create a new lock, if it does not exist
-        if(locks.find(std::string(handle_.name())) == locks.end())
+        if(locks.find(std::string(handles_[0].name())) == locks.end())
         {
             locks.insert(
-                {std::string(handle_.name()),std::make_shared<SpinLock>()}
+                {std::string(handles_[0].name()),std::make_shared<SpinLock>()}
             );
         }
 
-        // std::pmr 
-        pool_ = std::make_shared<std::pmr::monotonic_buffer_resource>(handle_.get(),handle_.size(),
-                    std::pmr::null_memory_resource());
-
         return true;
     }
 
     virtual Descriptor write(void const *data, const std::size_t &size,const uint32_t &cnt) final
     {
-        
-        std::chrono::time_point<std::chrono::steady_clock> now = std::chrono::steady_clock::now();
-        recyle_memory(now);
+        void *payload = nullptr;
+        auto desc = loan(size, payload);
+        if (payload)
+        {
+            memcpy(payload, data, size);
+            commit(desc, cnt);
+        }
+        return desc;
+    }
+
+    virtual Descriptor loan(const std::size_t &size, void *&data) final
+    {
+        data = nullptr;
+        // up to half the pool, so one payload never starves every other writer of the sender
+        if (!extents_ || (size > size_ / 2))
+        {
+            return {};
+        }
+        if (!use_fifo_)
+        {
+            recyle_memory(RECLAIM_BATCH);
+        }
 
         auto pool_size = align_size(size + sizeof(uint32_t), alignof(std::max_align_t));
         void *pool_data = nullptr;
 
-        auto it = locks.find(std::string(handle_.name()));
+        auto it = locks.find(std::string(handles_[0].name()));
         if ( it != locks.end())
         {
             std::lock_guard<SpinLock> l(*(it->second));
-            pool_data = pool_->allocate(pool_size);
+            pool_data = use_fifo_ ? allocate_fifo(size + sizeof(uint32_t)) : allocate(pool_size);
         }
 
         if(!pool_data)
@@ -139,53 +236,216 @@ public:
             return {};
         }
 
+        // the loan holds the only reference until it is committed, so no sweep takes the payload back
         std::atomic<uint32_t> *count = static_cast<std::atomic<uint32_t>*>(pool_data);
-        count->store(cnt,std::memory_order_relaxed);
-        memcpy(static_cast<char*>(pool_data) + sizeof(uint32_t),data,size);
-        
-        map_.insert(
-            {pool_data,std::make_tuple(pool_size,now)}
-        );
+        count->store(1,std::memory_order_relaxed);
+        if (!use_fifo_)
+        {
+            inflight_.push_back({pool_data, pool_size});
+        }
+        data = static_cast<char*>(pool_data) + sizeof(uint32_t);
 
         return
         {
-            id_,
-            reinterpret_cast<std::size_t>(pool_data) - reinterpret_cast<std::size_t>(handle_.get()),
-            pool_size
+            producer_,
+            offset_of(pool_data),
+            static_cast<uint32_t>(size),
+            epoch_
         };
     }
 
+    virtual void commit(const Descriptor &desc, const uint32_t &cnt) final
+    {
+        if (auto *count = count_of(desc))
+        {
+            count->store(cnt, std::memory_order_relaxed);
+        }
+    }
+
+    virtual void discard(const Descriptor &desc) final
+    {
+        // the next writes reclaim it
+        if (auto *count = count_of(desc))
+        {
+            count->store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // Extents mapped so far.
+    uint32_t extents() const noexcept
+    {
+        return extents_;
+    }
+
 private:
-    void recyle_memory(const std::chrono::time_point<std::chrono::steady_clock> &now)
+    // Reference count in front of a payload of this sender.
+    std::atomic<uint32_t> *count_of(const Descriptor &desc)
+    {
+        auto const extent = extent_of(desc.offset());
+        if (!desc.length() || (extent >= extents_))
+        {
+            return nullptr;
+        }
+        return reinterpret_cast<std::atomic<uint32_t>*>(static_cast<char*>(handles_[extent].get()) +
+                                                        (desc.offset() - extent_start(extent)));
+    }
+
+    // Maps the next extent, false once the pool has reached its size.
+    bool grow()
+    {
+        auto const start = extent_start(extents_);
+        if ((extents_ >= MAX_EXTENTS) || (start >= size_))
+        {
+            return false;
+        }
+        auto const size = (std::min)(DEFAULT_EXTENT_SIZE << extents_, size_ - start);
+        auto name = pool_name(channel_, producer_, epoch_, extents_);
+        auto &handle = handles_[extents_];
+        if (!handle.acquire(name.c_str(), size) || !handle.valid())
+        {
+            handle.release();
+            return false;
+        }
+        // the handle keeps its reference count behind the size asked for, the allocators stay in front of it
+        if (use_fifo_)
+        {
+            fifos_[extents_] = std::make_shared<BipBuffer>(handle.get(), size);
+        }
+        else
+        {
+            pools_[extents_] = std::make_shared<Slab>(handle.get(), size);
+        }
+        ++extents_;
+        return true;
+    }
+
+    uint32_t extent_at(void const *p)
+    {
+        uint32_t i = 0;
+        while ((i + 1 < extents_) &&
+               ((p < handles_[i].get()) || (p >= static_cast<char *>(handles_[i].get()) + handles_[i].size())))
+        {
+            ++i;
+        }
+        return i;
+    }
+
+    uint32_t offset_of(void const *p)
+    {
+        auto const extent = extent_at(p);
+        return static_cast<uint32_t>(extent_start(extent) +
+                                     (static_cast<char const *>(p) - static_cast<char *>(handles_[extent].get())));
+    }
+
+    void deallocate(void *p, std::size_t size)
+    {
+        pools_[extent_at(p)]->deallocate(p, size);
+    }
+
+    // Earlier extents first. Once none of them has room the whole backlog is swept,
+    // a new extent is only mapped if that did not free enough either.
+    void *allocate(const std::size_t &size)
+    {
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            if (pass)
+            {
+                recyle_memory(inflight_.size());
+            }
+            for (uint32_t i = 0; i < extents_; ++i)
+            {
+                if (auto *p = pools_[i]->allocate(size))
+                {
+                    return p;
+                }
+            }
+        }
+        while (grow())
+        {
+            if (auto *p = pools_[extents_ - 1]->allocate(size))
+            {
+                return p;
+            }
+        }
+        return nullptr;
+    }
+
+    // No inflight_ bookkeeping, every ring knows its oldest payload.
+    // Writes stay on one extent until it is full, then move on to the next one with room.
+    void *allocate_fifo(const std::size_t &size)
     {
-        if(map_.empty())
+        // the tail stops at the first payload still being read or loaned out, however long that takes:
+        // a reader that goes away gives its references back
+        auto done = [](void *block) {
+            return !static_cast<std::atomic<uint32_t>*>(block)->load(std::memory_order_acquire);
+        };
+        for (uint32_t n = 0; n < extents_; ++n)
+        {
+            auto const i = (current_ + n) % extents_;
+            fifos_[i]->reclaim(done);
+            if (auto *p = fifos_[i]->allocate(size))
+            {
+                current_ = i;
+                return p;
+            }
+        }
+        while (grow())
         {
-            return;
+            current_ = extents_ - 1;
+            if (auto *p = fifos_[current_]->allocate(size))
+            {
+                return p;
+            }
         }
-        for (auto it = map_.begin(); it != map_.end();)
+        return nullptr;
+    }
+
+    // Looks at up to `budget` in-flight payloads, oldest first. One still being read goes to the back,
+    // so every write does bounded work however large the backlog, and payloads given back
+    // out of order are still found within a sweep.
+    // A payload stays tracked as long as it is referenced, however long that takes: readers that go away
+    // give their references back, those that died are reaped by a writer that runs out of room,
+    // and a reference still held means the payload may still be read.
+    void recyle_memory(std::size_t budget)
+    {
+        for (; budget && !inflight_.empty(); --budget)
         {
-            std::atomic<uint32_t> *count = static_cast<std::atomic<uint32_t>*>(it->first);
-            if(!count->load() || (std::chrono::duration_cast<std::chrono::milliseconds>(now - std::get<1>(it->second)).count() >= DEFAULT_TIMEOUT_VALUE))
+            auto block = inflight_.front();
+            inflight_.pop_front();
+            std::atomic<uint32_t> *count = static_cast<std::atomic<uint32_t>*>(block.data);
+            if(!count->load(std::memory_order_acquire))
             {
-                pool_->deallocate(it->first,std::get<0>(it->second));
-                it = map_.erase(it);
+                deallocate(block.data, block.size);
             }
             else
             {
-                ++it;
+                inflight_.push_back(block);
             }
         }
     }
 
 private:
-    // thread id
-    std::thread::id id_;
-    // shm handle
-    Handle handle_;
-    // shared memory manager
-    std::shared_ptr<std::pmr::monotonic_buffer_resource> pool_;
-    // already memory using map
-    std::unordered_map<void*,std::tuple<std::size_t,std::chrono::time_point<std::chrono::steady_clock>>> map_;
+    // connection slot and its epoch, they name the pool
+    uint32_t producer_;
+    uint32_t epoch_;
+    std::string channel_;
+    // extents mapped so far and the bytes all of them may add up to
+    uint32_t extents_;
+    std::size_t size_;
+    // shm handles of the extents and their memory managers, size-class slabs or FIFO rings
+    std::array<Handle, MAX_EXTENTS> handles_;
+    std::array<std::shared_ptr<Slab>, MAX_EXTENTS> pools_;
+    std::array<std::shared_ptr<BipBuffer>, MAX_EXTENTS> fifos_;
+    // the ring FIFO writes go to
+    uint32_t current_;
+    bool use_fifo_;
+    // payloads handed out and not reclaimed yet, in the order the sweep visits them
+    struct inflight_t
+    {
+        void *data;
+        std::size_t size;
+    };
+    std::deque<inflight_t> inflight_;
 };
 
 template<>
@@ -194,67 +454,97 @@ class Cache<RECEIVER> : public CacheBase
 public:
     Cache<RECEIVER>()
         : CacheBase()
-        , handles_()
+        , channel_()
+        , producers_()
     {
         
     }
 
     virtual ~Cache<RECEIVER>()
     {
-        handles_.clear();
     }
 public:
-    virtual bool init() final
+    virtual bool init(const std::string &channel, const uint32_t &, const uint32_t &) final
     {
+        channel_ = channel;
         return true;
     }
 
     virtual bool read(const Descriptor &desc, std::function<void(const Buffer *)> callback) final
     {
-        Handle *handle = get_handle(desc.id());
-        if(!handle || !callback)
+        void *pool_data = payload_of(desc);
+        if(!pool_data || !callback)
         {
             return false;
         }
-        void *pool_data = static_cast<char*>(handle->get()) + desc.offset();
 
-        Buffer buf(static_cast<char*>(pool_data) + sizeof(uint32_t), desc.length() - sizeof(uint32_t));
+        Buffer buf(static_cast<char*>(pool_data) + sizeof(uint32_t), desc.length());
         if(!buf.empty())
         { 
             callback(&buf);
         }
-        static_cast<std::atomic<uint32_t>*>(pool_data)->fetch_sub(1, std::memory_order_relaxed);
-        return !(*static_cast<std::atomic<uint32_t>*>(pool_data));
+        // the payload reads above happen before the writer may see the count drop and reuse the block
+        return static_cast<std::atomic<uint32_t>*>(pool_data)->fetch_sub(1, std::memory_order_acq_rel) == 1;
+    }
+
+    // Only the reference count in front of the payload is touched, the payload itself is never read.
+    virtual bool release(const Descriptor &desc) final
+    {
+        auto *count = static_cast<std::atomic<uint32_t>*>(payload_of(desc));
+        if(!count)
+        {
+            return false;
+        }
+        return count->fetch_sub(1, std::memory_order_acq_rel) == 1;
     }
 private:
 
-    Handle *get_handle(const std::thread::id &id)
+    // Producers are looked up by their connection slot, a new epoch means the slot changed hands.
+    // Extents of a pool are mapped the first time a payload in them shows up.
+    void *payload_of(const Descriptor &desc)
     {
-        auto it = handles_.find(id);
-        if(it == handles_.end())
+        if (!desc.producer() || desc.producer() > producers_.size())
+        {
+            return nullptr;
+        }
+        auto &producer = producers_[desc.producer() - 1];
+        if (producer.epoch != desc.epoch())
         {
-            Handle handle;
-            auto name = DEFAULT_SHM_NAME + thread_id_to_string(id);
-            if (!handle.acquire(name.c_str(), DEFAULT_CACHE_SIZE, open))
+            for (auto &handle : producer.extents)
             {
-                return nullptr;
+                handle.release();
             }
-            else
+            producer.epoch = desc.epoch();
+        }
+        auto const extent = extent_of(desc.offset());
+        auto &handle = producer.extents[extent];
+        if (!handle.valid())
+        {
+            auto name = pool_name(channel_, desc.producer(), desc.epoch(), extent);
+            if (!handle.acquire(name.c_str(), 0, open) || !handle.valid())
             {
-                handles_.insert(
-                    {id, std::move(handle)}
-                );
-                return &(handles_[id]);
+                handle.release();
+                return nullptr;
             }
         }
-        else
+        auto const offset = desc.offset() - extent_start(extent);
+        if (offset + sizeof(uint32_t) + desc.length() > handle.size())
         {
-            return &(it->second);
+            return nullptr;
         }
+        return static_cast<char*>(handle.get()) + offset;
     }
 
 private:
-    std::unordered_map<std::thread::id,Handle> handles_;
+    struct producer_t
+    {
+        uint32_t epoch = 0;
+        std::array<Handle, MAX_EXTENTS> extents;
+    };
+
+    // channel name the pools are named after
+    std::string channel_;
+    std::array<producer_t, MAX_CONNECTIONS / 2> producers_;
 };
 
 } // namespace detail
@@ -39,7 +39,8 @@ uint32_t Connection::connect(const unsigned &mode) noexcept
     }
     if(cur_pos == end_pos)
     {
-        assert("The maximum subscript is exceeded.");
+        // The maximum subscript is exceeded.
+        return 0;
     }
     return cur_pos + 1;
 }
@@ -1,18 +1,474 @@
 #include "Content.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <signal.h>
+#include <unistd.h>
 
 namespace ipc
 {
 namespace detail
 {
 
+namespace
+{
+    // Whether process `pid` is still there, one we may not signal is.
+    bool alive(int32_t pid) noexcept
+    {
+        return (::kill(pid, 0) == 0) || (errno != ESRCH);
+    }
+} // internal-linkage
+
+void Content::init(Options const &options) noexcept
+{
+    use_lanes_ = options.lanes;
+    single_reader_ = options.lanes || options.chained || options.conflate;
+    competing_ = options.competing;
+    overwrite_ = options.overwrite;
+    conflate_ = options.conflate;
+    retain_ = options.retain;
+    capacity_ = options.capacity;
+    priorities_ = options.priorities;
+}
+
 uint32_t Content::rd() const noexcept
 {
-    return r_.load(std::memory_order_acquire);
+    uint32_t cur_rd = 0;
+    if (use_lanes_)
+    {
+        for (auto const &lane : lanes_)
+        {
+            cur_rd += lane.r_.load(std::memory_order_acquire);
+        }
+        return cur_rd;
+    }
+    for (uint32_t prio = 0; prio < priorities_; ++prio)
+    {
+        cur_rd += rings_[prio].r_.load(std::memory_order_acquire);
+    }
+    return cur_rd;
 }
 
 uint32_t Content::wr() const noexcept
 {
-    return w_.load(std::memory_order_acquire);
+    uint32_t cur_wt = 0;
+    if (use_lanes_)
+    {
+        for (auto const &lane : lanes_)
+        {
+            cur_wt += lane.w_.load(std::memory_order_acquire);
+        }
+        return cur_wt;
+    }
+    for (uint32_t prio = 0; prio < priorities_; ++prio)
+    {
+        cur_wt += rings_[prio].w_.load(std::memory_order_acquire);
+    }
+    return cur_wt;
+}
+
+uint32_t Content::connect(const unsigned &mode) noexcept
+{
+    auto cc_id = Connection::connect(mode);
+    if (is_sender(cc_id))
+    {
+        epochs_[cc_id - 1].fetch_add(1, std::memory_order_acq_rel);
+    }
+    if (is_reader(cc_id))
+    {
+        auto guard = std::unique_lock(lcc_);
+        bool const busy = std::any_of(std::begin(readers_), std::end(readers_), [](reader_t const &reader)
+            {
+                return reader.active_.load(std::memory_order_acquire);
+            });
+        if (single_reader_ && busy)
+        {
+            // lanes, chained and conflating rings are single-consumer
+            guard.unlock();
+            Connection::disconnect(mode, cc_id);
+            return 0;
+        }
+        // Alone, a reader resumes at the read index the writers work with: the messages from there on were
+        // counted for the reader that left them, or for the next one to come while nobody read at all.
+        // Next to other readers it joins at the live end, what they still hold was not counted for it.
+        bool const late = busy || std::any_of(std::begin(groups_), std::end(groups_), [](group_t const &group)
+            {
+                return group.members_ != 0;
+            });
+        auto &reader = reader_of(cc_id);
+        for (uint32_t prio = 0; prio < MaxPriorities; ++prio)
+        {
+            auto start = late ? rings_[prio].w_.load(std::memory_order_acquire) : rings_[prio].r_.load(std::memory_order_acquire);
+            if (use_lanes_)
+            {
+                start = (prio == 0) ? rd() : 0;
+            }
+            else if (competing_)
+            {
+                start = rings_[prio].c_.load(std::memory_order_acquire);
+            }
+            else if (retain_)
+            {
+                // a log is joined at its live end, the retained messages are there to seek back to
+                start = rings_[prio].w_.load(std::memory_order_acquire);
+            }
+            else if (overwrite_)
+            {
+                // nobody holds slots on a lossy channel, begin with the oldest one not overwritten yet
+                auto cur_wt = rings_[prio].w_.load(std::memory_order_acquire);
+                start = (cur_wt > capacity_) ? (cur_wt - capacity_) : 0;
+            }
+            reader.cursor_[prio].store(start, std::memory_order_relaxed);
+        }
+        reader.skipped_.store(0, std::memory_order_relaxed);
+        reader.owner_.store(static_cast<int32_t>(::getpid()), std::memory_order_relaxed);
+        reader.active_.store(true, std::memory_order_release);
+        roster_.fetch_add(1, std::memory_order_release);
+    }
+    return cc_id;
+}
+
+uint32_t Content::disconnect(const unsigned &mode, uint32_t cc_id) noexcept
+{
+    if (is_reader(cc_id))
+    {
+        // Hand what the leaving reader consumed over to r_ first,
+        // so the next reader of a channel resumes where this one stopped.
+        for (uint32_t prio = 0; !use_lanes_ && (prio < priorities_); ++prio)
+        {
+            refresh(prio);
+        }
+        auto guard = std::unique_lock(lcc_);
+        auto &reader = reader_of(cc_id);
+        if (auto group = reader.group_.exchange(0, std::memory_order_acq_rel))
+        {
+            // the last member takes the group down, writers stop waiting for it
+            if (--groups_[group - 1].members_ == 0)
+            {
+                groups_[group - 1].name_[0] = '\0';
+            }
+        }
+        reader.active_.store(false, std::memory_order_release);
+        roster_.fetch_add(1, std::memory_order_release);
+    }
+    return Connection::disconnect(mode, cc_id);
+}
+
+bool Content::join(uint32_t cc_id, char const *name) noexcept
+{
+    if (!is_reader(cc_id) || single_reader_ || overwrite_ || competing_ ||
+            (name == nullptr) || (name[0] == '\0') || (std::strlen(name) >= MaxGroupName))
+    {
+        return false;
+    }
+    auto guard = std::unique_lock(lcc_);
+    auto &reader = reader_of(cc_id);
+    if (!reader.active_.load(std::memory_order_acquire) || reader.group_.load(std::memory_order_relaxed))
+    {
+        return false;
+    }
+    uint32_t found = MaxGroups, vacant = MaxGroups;
+    for (uint32_t i = 0; i < MaxGroups; ++i)
+    {
+        if (groups_[i].members_ && (std::strncmp(groups_[i].name_, name, MaxGroupName) == 0))
+        {
+            found = i;
+            break;
+        }
+        if (!groups_[i].members_ && (vacant == MaxGroups))
+        {
+            vacant = i;
+        }
+    }
+    if (found == MaxGroups)
+    {
+        if (vacant == MaxGroups)
+        {
+            return false; // no group slot left
+        }
+        found = vacant;
+        auto &group = groups_[found];
+        std::strncpy(group.name_, name, MaxGroupName - 1);
+        for (uint32_t prio = 0; prio < MaxPriorities; ++prio)
+        {
+            auto cur = reader.cursor_[prio].load(std::memory_order_relaxed);
+            group.c_[prio].store(cur, std::memory_order_relaxed);
+            group.d_[prio].store(cur, std::memory_order_relaxed);
+            // marks a previous group in this slot left behind must not pass for tickets of the new one
+            for (auto &mark : group.done_[prio])
+            {
+                mark.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+    auto &group = groups_[found];
+    ++group.members_;
+    for (uint32_t prio = 0; prio < MaxPriorities; ++prio)
+    {
+        reader.cursor_[prio].store(group.c_[prio].load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+    reader.group_.store(found + 1, std::memory_order_release);
+    roster_.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+bool Content::seek(uint32_t cc_id, uint32_t prio, uint32_t ticket) noexcept
+{
+    if (!retain_ || !is_reader(cc_id) || (prio >= priorities_))
+    {
+        return false;
+    }
+    // refresh() moves r_ under the same lock, nothing from r_ on is reused before the cursor passes it
+    auto guard = std::unique_lock(lcc_);
+    auto &reader = reader_of(cc_id);
+    auto const &ring = rings_[prio];
+    if (!reader.active_.load(std::memory_order_acquire) || reader.group_.load(std::memory_order_relaxed) ||
+            (static_cast<int32_t>(ticket - ring.r_.load(std::memory_order_acquire)) < 0) ||
+            (static_cast<int32_t>(ring.w_.load(std::memory_order_acquire) - ticket) < 0))
+    {
+        return false;
+    }
+    reader.cursor_[prio].store(ticket, std::memory_order_release);
+    return true;
+}
+
+uint32_t Content::consumers() noexcept
+{
+    auto guard = std::unique_lock(lcc_);
+    uint32_t n = 0;
+    for (auto const &reader : readers_)
+    {
+        if (reader.active_.load(std::memory_order_acquire) && !reader.group_.load(std::memory_order_relaxed))
+        {
+            ++n;
+        }
+    }
+    for (auto const &group : groups_)
+    {
+        n += group.members_ ? 1 : 0;
+    }
+    return n;
+}
+
+uint32_t Content::consumers(uint32_t prio, uint32_t ticket) noexcept
+{
+    // No cursor passes a ticket that is not committed. A reader that connected after it was taken
+    // started at w_ beyond it, under the lock held here, so it is the only kind of reader ahead of it.
+    auto const gets = [ticket](std::atomic<uint32_t> const &cursor)
+    {
+        return static_cast<int32_t>(ticket - cursor.load(std::memory_order_acquire)) >= 0;
+    };
+    auto guard = std::unique_lock(lcc_);
+    uint32_t n = 0;
+    for (auto const &reader : readers_)
+    {
+        if (reader.active_.load(std::memory_order_acquire) && !reader.group_.load(std::memory_order_relaxed) &&
+                gets(reader.cursor_[prio]))
+        {
+            ++n;
+        }
+    }
+    for (auto const &group : groups_)
+    {
+        n += (group.members_ && gets(group.c_[prio])) ? 1 : 0;
+    }
+    return n;
+}
+
+bool Content::orphans(uint32_t cc_id) noexcept
+{
+    if (!is_reader(cc_id) || competing_)
+    {
+        return false;
+    }
+    auto guard = std::unique_lock(lcc_);
+    auto const &reader = reader_of(cc_id);
+    auto const group = reader.group_.load(std::memory_order_relaxed);
+    if (!reader.active_.load(std::memory_order_acquire) || (group && (groups_[group - 1].members_ > 1)))
+    {
+        return false;
+    }
+    for (auto const &other : readers_)
+    {
+        if ((&other != &reader) && other.active_.load(std::memory_order_acquire) &&
+                !other.group_.load(std::memory_order_relaxed))
+        {
+            return true;
+        }
+    }
+    for (uint32_t i = 0; i < MaxGroups; ++i)
+    {
+        if (groups_[i].members_ && (i + 1 != group))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t Content::claim_dead() noexcept
+{
+    auto guard = std::unique_lock(lcc_);
+    for (uint32_t i = 0; i < (MAX_CONNECTIONS / 2); ++i)
+    {
+        auto &reader = readers_[i];
+        auto const owner = reader.owner_.load(std::memory_order_relaxed);
+        if (reader.active_.load(std::memory_order_acquire) && owner && !alive(owner))
+        {
+            reader.owner_.store(static_cast<int32_t>(::getpid()), std::memory_order_relaxed);
+            return i + 1 + (MAX_CONNECTIONS / 2);
+        }
+    }
+    return 0;
+}
+
+uint32_t Content::cursor(uint32_t cc_id, uint32_t prio) const noexcept
+{
+    if (prio >= MaxPriorities)
+    {
+        return 0;
+    }
+    if (!is_reader(cc_id))
+    {
+        return use_lanes_ ? rd() : rings_[prio].r_.load(std::memory_order_acquire);
+    }
+    return readers_[cc_id - 1 - (MAX_CONNECTIONS / 2)].cursor_[prio].load(std::memory_order_acquire);
+}
+
+uint32_t Content::skipped(uint32_t cc_id) const noexcept
+{
+    if (!is_reader(cc_id))
+    {
+        return 0;
+    }
+    return readers_[cc_id - 1 - (MAX_CONNECTIONS / 2)].skipped_.load(std::memory_order_acquire);
+}
+
+uint32_t Content::epoch(uint32_t cc_id) const noexcept
+{
+    if (!is_sender(cc_id))
+    {
+        return 0;
+    }
+    return epochs_[cc_id - 1].load(std::memory_order_acquire);
+}
+
+bool Content::reserve(uint32_t prio, uint32_t count, uint32_t capacity, uint32_t &cur_wt) noexcept
+{
+    auto &ring = rings_[prio];
+    if (count == 0 || count > capacity)
+    {
+        return false;
+    }
+    cur_wt = ring.w_.load(std::memory_order_relaxed);
+    for (unsigned k = 0;;)
+    {
+        auto used = static_cast<int32_t>(cur_wt - ring.r_.load(std::memory_order_acquire));
+        if (used < 0)
+        {
+            // r_ overtook a stale ticket, reload it
+            cur_wt = ring.w_.load(std::memory_order_relaxed);
+            continue;
+        }
+        if (static_cast<uint32_t>(used) + count > capacity)
+        {
+            if (refresh(prio))
+            {
+                continue; // the slowest reader moved on
+            }
+            return false;
+        }
+        if (ring.w_.compare_exchange_weak(cur_wt, cur_wt + count, std::memory_order_acq_rel, std::memory_order_relaxed))
+        {
+            advance(ring, cur_wt, cur_wt + count);
+            return true;
+        }
+        yield(k);
+    }
+}
+
+uint32_t Content::seal(uint32_t prio) noexcept
+{
+    auto &ring = rings_[prio];
+    auto cur_wt = ring.w_.load(std::memory_order_acquire);
+    for (unsigned k = 0;;)
+    {
+        if (static_cast<uint32_t>(cur_wt - ring.r_.load(std::memory_order_acquire)) > capacity_)
+        {
+            break; // sealed already
+        }
+        if (ring.w_.compare_exchange_weak(cur_wt, cur_wt + capacity_ + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            cur_wt += capacity_ + 1;
+            break;
+        }
+        yield(k);
+    }
+    return cur_wt - capacity_ - 1;
+}
+
+void Content::unseal(uint32_t prio) noexcept
+{
+    auto &ring = rings_[prio];
+    ring.w_.store(ring.w_.load(std::memory_order_acquire) - capacity_ - 1, std::memory_order_release);
+}
+
+bool Content::drained(uint32_t prio, uint32_t cur) const noexcept
+{
+    return rings_[prio].w_.load(std::memory_order_acquire) - capacity_ - 1 == cur;
+}
+
+bool Content::refresh(uint32_t prio) noexcept
+{
+    auto &ring = rings_[prio];
+    if (competing_)
+    {
+        // slots below d_ are free whoever claimed them, and unclaimed messages wait for the next reader
+        auto cur_rd = ring.d_.load(std::memory_order_acquire);
+        if (static_cast<int32_t>(cur_rd - ring.r_.load(std::memory_order_relaxed)) <= 0)
+        {
+            return false;
+        }
+        ring.r_.store(cur_rd, std::memory_order_release);
+        return true;
+    }
+    // Runs under the connection lock, so a reader can not register behind the new r_ meanwhile.
+    auto guard = std::unique_lock(lcc_);
+    auto cur_wt = ring.w_.load(std::memory_order_acquire);
+    bool found = false;
+    uint32_t lag = 0;
+    for (auto &reader : readers_)
+    {
+        if (!reader.active_.load(std::memory_order_acquire))
+        {
+            continue;
+        }
+        found = true;
+        if (reader.group_.load(std::memory_order_relaxed))
+        {
+            continue; // its group holds the slots
+        }
+        // a cursor ahead of the snapshot just lags 0
+        auto diff = static_cast<int32_t>(cur_wt - reader.cursor_[prio].load(std::memory_order_acquire));
+        lag = (std::max)(lag, static_cast<uint32_t>((std::max)(diff, 0)));
+    }
+    for (auto &group : groups_)
+    {
+        if (group.members_)
+        {
+            auto diff = static_cast<int32_t>(cur_wt - group.d_[prio].load(std::memory_order_acquire));
+            lag = (std::max)(lag, static_cast<uint32_t>((std::max)(diff, 0)));
+        }
+    }
+    // a retaining ring keeps its window whether anybody reads or not
+    lag = (std::max)(lag, retain_);
+    auto cur_rd = ring.r_.load(std::memory_order_relaxed);
+    if ((!found && !retain_) || static_cast<int32_t>((cur_wt - lag) - cur_rd) <= 0)
+    {
+        return false;
+    }
+    ring.r_.store(cur_wt - lag, std::memory_order_release);
+    return true;
 }
 
 } // namespace detail
@@ -3,9 +3,11 @@
 
 #include <utility>
 #include <cstring>
+#include <atomic>
 #include <bitset>
 #include <type_traits>
 #include <ipc/def.h>
+#include <config.h>
 #include <core/Connection.h>
 #include <sync/RwLock.h>
 #include <iostream>
@@ -22,50 +24,661 @@ namespace detail
 // Minimum offset between two objects to avoid false sharing.
 const static uint8_t Align = 64;
 
+// Rings a channel can have, one per priority class.
+constexpr uint32_t MaxPriorities = static_cast<uint32_t>(Priority::MAX_PRIORITIES);
+
+// Consumer groups a route can have at a time, and the longest group name.
+constexpr uint32_t MaxGroups = 8;
+constexpr std::size_t MaxGroupName = 32;
+
+// Tickets competing readers may claim ahead of the oldest one not handed back yet.
+constexpr uint32_t ClaimWindow = 64;
+
 class Content : public Connection
 {
 public:
     template <std::size_t DataSize, std::size_t AlignSize>
     struct elem_t
     {
+        // Commit sequence, equals (ticket + 1) once the writer holding the ticket published the slot.
+        // Lossy and conflating channels use stamp_of(ticket) instead, odd while a writer is filling the slot.
+        std::atomic<uint32_t> seq_{0};
         std::aligned_storage_t<DataSize, AlignSize> data_{};
     };
+
+    // Cursors of a connected reader, one per ring, kept in shared memory so writers can see who is lagging.
+    struct alignas(Align) reader_t
+    {
+        std::atomic<uint32_t> cursor_[MaxPriorities]{};
+        std::atomic<bool> active_{false};
+        // messages the reader lost because the writers lapped it, lossy channels only
+        std::atomic<uint32_t> skipped_{0};
+        // consumer group + 1, 0 while the reader reads on its own
+        std::atomic<uint32_t> group_{0};
+        // process holding the connection, the one that took it over once the reader died
+        std::atomic<int32_t> owner_{0};
+    };
+
+    // Readers of a group share its claim and hand-back indices, like the readers of a competing ring.
+    struct alignas(Align) group_t
+    {
+        char name_[MaxGroupName]{};
+        uint32_t members_ = 0; // guarded by the connection lock, 0 when the slot is free
+        alignas(Align) std::atomic<uint32_t> c_[MaxPriorities]{};
+        alignas(Align) std::atomic<uint32_t> d_[MaxPriorities]{};
+        alignas(Align) std::atomic<uint32_t> done_[MaxPriorities][ClaimWindow]{};
+    };
+
+    // Indices of the ring of one priority class.
+    struct ring_t
+    {
+        // Read index seen by the writers, the slowest connected reader as of the last refresh().
+        // Readers never touch it, they only publish their own cursor.
+        alignas(Align) std::atomic<uint32_t> r_{0};
+        alignas(Align) std::atomic<uint32_t> w_{0}; // write index (next ticket)
+        // 64-bit number of a recent ticket, moved on every 2^30 tickets, so every process extends a ticket alike
+        std::atomic<uint64_t> base_{0};
+        // Competing readers only: the next ticket to claim, and the one below which all claimed slots are handed back.
+        alignas(Align) std::atomic<uint32_t> c_{0};
+        alignas(Align) std::atomic<uint32_t> d_{0};
+        // ticket + 1 of a claimed slot once it is copied out, by ticket modulo ClaimWindow
+        alignas(Align) std::atomic<uint32_t> done_[ClaimWindow]{};
+    };
+
+    // Key table of a conflating ring, one entry per ring slot: the key of the message in that slot,
+    // and the ticket + 1 of the last message whose key hashes to the entry (0: none yet).
+    struct alignas(16) keyed_t
+    {
+        std::atomic<uint64_t> key_{0};
+        std::atomic<uint32_t> latest_{0};
+    };
+
+    // Private ring of one sender, written by that sender and read by the only reader.
+    struct lane_t
+    {
+        alignas(Align) std::atomic<uint32_t> w_{0};
+        alignas(Align) std::atomic<uint32_t> r_{0};
+    };
+
 public:
+    void init(Options const &options) noexcept;
+
+    // Read and write index summed over all rings, `wr() - cursor` is what a reader has pending.
     uint32_t rd() const noexcept;
     uint32_t wr() const noexcept;
 
+    uint32_t connect(const unsigned &mode = SENDER) noexcept;
+    uint32_t disconnect(const unsigned &mode = SENDER, uint32_t cc_id = 0) noexcept;
+
+    // Start cursor of a connection in a ring, readers get the position registered on connect.
+    uint32_t cursor(uint32_t cc_id, uint32_t prio = 0) const noexcept;
+
+    uint32_t skipped(uint32_t cc_id) const noexcept;
+
+    // Generation of a sender slot, bumped whenever a sender takes it.
+    uint32_t epoch(uint32_t cc_id) const noexcept;
+
+    // Makes a connected reader a member of consumer group `name`, a new group starts where the reader stands.
+    // Every group gets every message, within a group each message goes to one member.
+    bool join(uint32_t cc_id, char const *name) noexcept;
+
+    // Moves the cursor of a reader of a retaining ring to `ticket`, anywhere from the oldest message
+    // the writers can no longer reuse (r_) up to the write index.
+    bool seek(uint32_t cc_id, uint32_t prio, uint32_t ticket) noexcept;
+
+    // 64-bit number of `ticket` of ring `prio`, counted from the first message ever written to it.
+    uint64_t sequence(uint32_t prio, uint32_t ticket) const noexcept
+    {
+        return extend(rings_[prio].base_.load(std::memory_order_acquire), ticket);
+    }
+
+    // 64-bit number of `ticket` given the number `base` of a ticket less than 2^31 away from it.
+    static constexpr uint64_t extend(uint64_t base, uint32_t ticket) noexcept
+    {
+        return base + static_cast<uint64_t>(static_cast<int64_t>(static_cast<int32_t>(ticket - static_cast<uint32_t>(base))));
+    }
+
+    // Readers each message has to reach, a group counts once.
+    uint32_t consumers() noexcept;
+
+    // Readers that get the message at `ticket` of ring `prio`, which must be taken and not committed yet.
+    uint32_t consumers(uint32_t prio, uint32_t ticket) noexcept;
+
+    // Changes whenever readers connect, join a group or leave, so a writer can tell
+    // whether what consumers() told it still holds.
+    uint32_t roster() const noexcept
+    {
+        return roster_.load(std::memory_order_acquire);
+    }
+
+    // Whether what reader `cc_id` has not read yet is left to nobody once it goes: no other member of its
+    // group takes it over, and other consumers keep the ring moving past it.
+    bool orphans(uint32_t cc_id) noexcept;
+
+    // Connection of a reader whose process died without disconnecting, 0 if there is none.
+    // The calling process takes it over, nobody else claims it unless that process dies as well.
+    uint32_t claim_dead() noexcept;
+
+    // Ends a ring for the writers: w_ jumps more than a lap ahead of anything a reader can reach,
+    // so reserve() finds it full for good. Returns the ticket the ring ends at.
+    uint32_t seal(uint32_t prio) noexcept;
+
+    // Lets writers continue at the end of a sealed ring, all of its readers must have drained it.
+    void unseal(uint32_t prio) noexcept;
+
+    // Whether a reader at `cur` consumed everything of a sealed ring.
+    bool drained(uint32_t prio, uint32_t cur) const noexcept;
+
+    // Visits (connection id, cursor summed over all rings, skipped) of every connected reader.
+    template <typename F>
+    void for_each_reader(F &&f)
+    {
+        auto guard = std::unique_lock(lcc_);
+        for (uint32_t i = 0; i < (MAX_CONNECTIONS / 2); ++i)
+        {
+            if (readers_[i].active_.load(std::memory_order_acquire))
+            {
+                uint32_t cursor = 0;
+                for (auto const &cur : readers_[i].cursor_)
+                {
+                    cursor += cur.load(std::memory_order_acquire);
+                }
+                f(i + 1 + (MAX_CONNECTIONS / 2), cursor, readers_[i].skipped_.load(std::memory_order_acquire));
+            }
+        }
+    }
+
 public:
+    // Multi-producer publish into the ring of priority class `prio`:
+    // a writer reserves a ticket by CAS on w_, fills the slot, then commits it through the slot sequence.
+    // Readers never trust w_, they only consume slots whose sequence matches their cursor.
+    // `f` gets the ticket of the slot it fills.
     template <typename W, typename F, typename Seg>
-    bool push(W * /*wrapper*/, F &&f, Seg *seg)
+    bool push(W *wrapper, uint32_t prio, F &&f, Seg *seg)
+    {
+        if (prio >= priorities_)
+        {
+            return false;
+        }
+        if (use_lanes_)
+        {
+            return push_lane(wrapper->connected_id(), 1, [&f](uint32_t, void *p, uint32_t t) { f(p, t); }, seg);
+        }
+        if (overwrite_)
+        {
+            return push_lossy(prio, 1, [&f](uint32_t, void *p, uint32_t t) { f(p, t); }, seg);
+        }
+        uint32_t cur_wt = 0;
+        if (!reserve(prio, 1, seg->capacity(), cur_wt))
+        {
+            return false; // full
+        }
+        auto *el = seg->at(prio, cur_wt);
+        std::forward<F>(f)(&(el->data_), cur_wt);
+        el->seq_.store(commit_of(cur_wt), std::memory_order_release);
+        return true;
+    }
+
+    // Publish on a conflating ring: a message whose key still has an unread one in the ring
+    // overwrites that one in place, otherwise it takes a new slot like push().
+    // The pending slot is locked by moving its stamp to odd, which also keeps the reader out until it is
+    // rewritten. The stamp names the ticket, so a stale entry never locks a slot reused by a later lap,
+    // taken or not. Hash collisions and lost races just take a new slot.
+    template <typename F, typename Seg>
+    bool push_keyed(uint32_t prio, uint64_t key, F &&f, Seg *seg)
+    {
+        if (!conflate_ || prio >= priorities_)
+        {
+            return false;
+        }
+        auto const mask = seg->capacity() - 1;
+        auto &entry = *seg->keyed(hash_of(key) & mask);
+        if (auto last = entry.latest_.load(std::memory_order_acquire))
+        {
+            auto const cur = last - 1;
+            auto *el = seg->at(prio, cur);
+            auto seq = stamp_of(cur);
+            if (el->seq_.compare_exchange_strong(seq, seq - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+            {
+                bool const same = (seg->keyed(cur & mask)->key_.load(std::memory_order_relaxed) == key);
+                if (same)
+                {
+                    std::forward<F>(f)(&(el->data_));
+                }
+                el->seq_.store(stamp_of(cur), std::memory_order_release);
+                if (same)
+                {
+                    return true;
+                }
+            }
+        }
+        uint32_t cur_wt = 0;
+        if (!reserve(prio, 1, seg->capacity(), cur_wt))
+        {
+            return false; // full
+        }
+        auto *el = seg->at(prio, cur_wt);
+        seg->keyed(cur_wt & mask)->key_.store(key, std::memory_order_relaxed);
+        std::forward<F>(f)(&(el->data_));
+        entry.latest_.store(cur_wt + 1, std::memory_order_release);
+        el->seq_.store(stamp_of(cur_wt), std::memory_order_release);
+        return true;
+    }
+
+    // Reserves `count` consecutive tickets with a single update of w_, or none of them if they do not fit.
+    // The first slot is committed last, readers stop in front of it until the whole set is in place,
+    // so they never see part of it. Lanes publish the set with their single index store anyway,
+    // a lossy ring may still overwrite part of a set before it is read.
+    template <typename W, typename F, typename Seg>
+    bool push_n(W *wrapper, uint32_t prio, uint32_t count, F &&f, Seg *seg)
+    {
+        if (prio >= priorities_)
+        {
+            return false;
+        }
+        if (use_lanes_)
+        {
+            return push_lane(wrapper->connected_id(), count, std::forward<F>(f), seg);
+        }
+        if (overwrite_)
+        {
+            return push_lossy(prio, count, std::forward<F>(f), seg);
+        }
+        uint32_t cur_wt = 0;
+        if (!reserve(prio, count, seg->capacity(), cur_wt))
+        {
+            return false; // full
+        }
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            f(i, &(seg->at(prio, cur_wt + i)->data_), cur_wt + i);
+        }
+        for (uint32_t i = count; i-- > 0;)
+        {
+            seg->at(prio, cur_wt + i)->seq_.store(commit_of(cur_wt + i), std::memory_order_release);
+        }
+        return true;
+    }
+
+    // A slot is handed back to the writers by publishing the reader cursor past it,
+    // `out` consumes the popped item before that happens.
+    template <typename W, typename F, typename R, typename Seg>
+    bool pop(W *wrapper, uint32_t prio, uint32_t &cur, F &&f, R &&out, Seg *seg)
+    {
+        if (use_lanes_ || overwrite_ || competing_ || conflate_ || group_of(wrapper->connected_id()))
+        {
+            return pop_n(wrapper, prio, cur, 1, [&f](uint32_t, void *p, uint32_t) { f(p); }, [&out](uint32_t) { return out(true); }, seg);
+        }
+        if (!is_reader(wrapper->connected_id()) || prio >= priorities_)
+        {
+            return false;
+        }
+        auto *el = seg->at(prio, cur);
+        if (el->seq_.load(std::memory_order_acquire) != cur + 1)
+        {
+            return false; // empty, or the writer holding this ticket has not committed yet
+        }
+        std::forward<F>(f)(&(el->data_));
+        ++cur;
+        std::forward<R>(out)(true);
+        reader_of(wrapper->connected_id()).cursor_[prio].store(cur, std::memory_order_release);
+        return true;
+    }
+
+    // Drains up to `count` committed slots of one ring and publishes the reader cursor once for all of them.
+    // `f` gets the ticket of every slot it copies, lanes pass the count of items the reader took before.
+    template <typename W, typename F, typename R, typename Seg>
+    uint32_t pop_n(W *wrapper, uint32_t prio, uint32_t &cur, uint32_t count, F &&f, R &&out, Seg *seg)
     {
-        auto cur_wt = static_cast<uint8_t>(w_.load(std::memory_order_relaxed));
-        if (cur_wt == static_cast<uint8_t>(r_.load(std::memory_order_acquire) - 1))
+        if (!is_reader(wrapper->connected_id()) || prio >= priorities_)
+        {
+            return 0;
+        }
+        if (use_lanes_)
+        {
+            return pop_lanes(wrapper, cur, count, std::forward<F>(f), std::forward<R>(out), seg);
+        }
+        if (overwrite_)
+        {
+            return pop_lossy(wrapper, prio, cur, count, std::forward<F>(f), std::forward<R>(out), seg);
+        }
+        if (conflate_)
+        {
+            return pop_taken(wrapper, prio, cur, count, std::forward<F>(f), std::forward<R>(out), seg);
+        }
+        if (competing_)
+        {
+            return pop_claim(wrapper, prio, rings_[prio].c_, rings_[prio].d_, rings_[prio].done_, cur, count,
+                             std::forward<F>(f), std::forward<R>(out), seg);
+        }
+        if (auto *group = group_of(wrapper->connected_id()))
+        {
+            return pop_claim(wrapper, prio, group->c_[prio], group->d_[prio], group->done_[prio], cur, count,
+                             std::forward<F>(f), std::forward<R>(out), seg);
+        }
+        uint32_t n = 0;
+        for (; n < count; ++n, ++cur)
+        {
+            auto *el = seg->at(prio, cur);
+            if (el->seq_.load(std::memory_order_acquire) != cur + 1)
+            {
+                break;
+            }
+            f(n, &(el->data_), cur);
+            out(n);
+        }
+        if (n)
+        {
+            reader_of(wrapper->connected_id()).cursor_[prio].store(cur, std::memory_order_release);
+        }
+        return n;
+    }
+
+private:
+    // A sender owns its lane, so it publishes with a plain store of the lane index.
+    template <typename F, typename Seg>
+    bool push_lane(uint32_t cc_id, uint32_t count, F &&f, Seg *seg)
+    {
+        if (!is_sender(cc_id) || count == 0)
+        {
+            return false;
+        }
+        auto &lane = lanes_[cc_id - 1];
+        auto cur_wt = lane.w_.load(std::memory_order_relaxed);
+        if ((cur_wt - lane.r_.load(std::memory_order_acquire)) + count > seg->capacity())
         {
             return false; // full
         }
-        std::forward<F>(f)(&(seg[cur_wt].data_));
-        w_.fetch_add(1, std::memory_order_release);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            f(i, &(seg->at(cc_id - 1, cur_wt + i)->data_), cur_wt + i);
+        }
+        lane.w_.store(cur_wt + count, std::memory_order_release);
         return true;
     }
 
+    // Takes one item per non-empty lane and pass, starting behind the lane served last,
+    // so a busy sender can not starve the others. `cur` counts what the reader consumed overall.
     template <typename W, typename F, typename R, typename Seg>
-    bool pop(W * /*wrapper*/, uint32_t &cur, F &&f, R &&out, Seg *seg)
+    uint32_t pop_lanes(W *wrapper, uint32_t &cur, uint32_t count, F &&f, R &&out, Seg *seg)
+    {
+        uint32_t n = 0;
+        for (bool found = true; found && (n < count);)
+        {
+            found = false;
+            for (uint32_t i = 0, start = next_lane_; (i < (MAX_CONNECTIONS / 2)) && (n < count); ++i)
+            {
+                auto id = (start + i) % (MAX_CONNECTIONS / 2);
+                auto &lane = lanes_[id];
+                auto cur_rd = lane.r_.load(std::memory_order_relaxed);
+                if (cur_rd == lane.w_.load(std::memory_order_acquire))
+                {
+                    continue;
+                }
+                f(n, &(seg->at(id, cur_rd)->data_), cur + n);
+                out(n);
+                lane.r_.store(cur_rd + 1, std::memory_order_release);
+                next_lane_ = id + 1;
+                found = true;
+                ++n;
+            }
+        }
+        if (n)
+        {
+            cur += n;
+            reader_of(wrapper->connected_id()).cursor_[0].store(cur, std::memory_order_release);
+        }
+        return n;
+    }
+
+    // Slot stamp of a ticket on a lossy channel: even once committed, the odd value below it while being written.
+    static constexpr uint32_t stamp_of(uint32_t ticket) noexcept
+    {
+        return (ticket + 1) * 2;
+    }
+
+    // Writers never wait for readers: they take tickets unconditionally and overwrite the oldest slots.
+    // A slot is claimed by moving its stamp to odd, so two writers a lap apart never fill it at once.
+    template <typename F, typename Seg>
+    bool push_lossy(uint32_t prio, uint32_t count, F &&f, Seg *seg)
     {
-        if (static_cast<uint8_t>(cur) == static_cast<uint8_t>(w_.load(std::memory_order_acquire)))
+        if (count == 0 || count > seg->capacity())
         {
-            return false; // empty
+            return false;
         }
-        std::forward<F>(f)(&(seg[static_cast<uint8_t>(cur++)].data_));
-        if(std::forward<R>(out)(true))
+        auto cur_wt = rings_[prio].w_.fetch_add(count, std::memory_order_acq_rel);
+        advance(rings_[prio], cur_wt, cur_wt + count);
+        for (uint32_t i = 0; i < count; ++i)
         {
-            r_.fetch_add(1, std::memory_order_release);
+            auto *el = seg->at(prio, cur_wt + i);
+            auto const stamp = stamp_of(cur_wt + i);
+            auto seq = el->seq_.load(std::memory_order_relaxed);
+            for (unsigned k = 0;; yield(k))
+            {
+                if (static_cast<int32_t>(seq - stamp) >= 0)
+                {
+                    break; // a writer of a later lap got here first, this item is already overwritten
+                }
+                if (!(seq & 1) &&
+                    el->seq_.compare_exchange_weak(seq, stamp - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+                {
+                    std::atomic_thread_fence(std::memory_order_release);
+                    f(i, &(el->data_), cur_wt + i);
+                    el->seq_.store(stamp, std::memory_order_release);
+                    break;
+                }
+                seq = el->seq_.load(std::memory_order_relaxed);
+            }
         }
         return true;
     }
 
+    // Items are copied out optimistically and kept only if the slot was not rewritten meanwhile.
+    // A reader that finds a later lap in its slot jumps to the oldest slot still worth reading,
+    // and stops the batch there, so the gap can be reported between the items around it.
+    template <typename W, typename F, typename R, typename Seg>
+    uint32_t pop_lossy(W *wrapper, uint32_t prio, uint32_t &cur, uint32_t count, F &&f, R &&out, Seg *seg)
+    {
+        auto &reader = reader_of(wrapper->connected_id());
+        uint32_t n = 0;
+        bool lapped = false;
+        while (n < count)
+        {
+            auto *el = seg->at(prio, cur);
+            auto seq = el->seq_.load(std::memory_order_acquire);
+            auto diff = static_cast<int32_t>(seq - stamp_of(cur));
+            if (diff < 0)
+            {
+                break; // not written yet
+            }
+            if (diff == 0)
+            {
+                f(n, &(el->data_), cur);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (el->seq_.load(std::memory_order_relaxed) == seq)
+                {
+                    ++cur;
+                    out(n++);
+                    continue;
+                }
+            }
+            auto next = rings_[prio].w_.load(std::memory_order_acquire) - seg->capacity();
+            if (static_cast<int32_t>(next - cur) <= 0)
+            {
+                next = cur + 1;
+            }
+            reader.skipped_.store(reader.skipped_.load(std::memory_order_relaxed) + (next - cur), std::memory_order_release);
+            cur = next;
+            lapped = true;
+            break;
+        }
+        if (n || lapped)
+        {
+            reader.cursor_[prio].store(cur, std::memory_order_release);
+        }
+        return n;
+    }
+
+    // Competing readers claim one ticket at a time with a CAS on the shared claim index and copy the slot out.
+    // The copy is marked in `marks` before `out` processes it, and whichever reader finds the oldest claimed
+    // ticket marked moves `done` past it and every marked one behind it. A reader held up while copying
+    // keeps the writers from reusing its slot, but never stalls the other readers: they go on claiming
+    // within ClaimWindow tickets of `done`.
+    template <typename W, typename F, typename R, typename Seg>
+    uint32_t pop_claim(W *wrapper, uint32_t prio, std::atomic<uint32_t> &claim, std::atomic<uint32_t> &done,
+                       std::atomic<uint32_t> *marks, uint32_t &cur, uint32_t count, F &&f, R &&out, Seg *seg)
+    {
+        auto cur_rd = claim.load(std::memory_order_acquire);
+        uint32_t n = 0;
+        while (n < count)
+        {
+            auto *el = seg->at(prio, cur_rd);
+            if ((cur_rd - done.load(std::memory_order_acquire) >= ClaimWindow) ||
+                    (el->seq_.load(std::memory_order_acquire) != cur_rd + 1))
+            {
+                auto now = claim.load(std::memory_order_acquire);
+                if (now == cur_rd)
+                {
+                    break; // empty, or the writer holding this ticket has not committed yet
+                }
+                cur_rd = now; // other readers took it meanwhile
+                continue;
+            }
+            if (!claim.compare_exchange_weak(cur_rd, cur_rd + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                continue;
+            }
+            f(n, &(el->data_), cur_rd);
+            marks[cur_rd % ClaimWindow].store(cur_rd + 1, std::memory_order_seq_cst);
+            hand_back(done, marks);
+            out(n++);
+            cur_rd = claim.load(std::memory_order_acquire);
+        }
+        cur = cur_rd;
+        reader_of(wrapper->connected_id()).cursor_[prio].store(cur, std::memory_order_release);
+        return n;
+    }
+
+    // Moves `done` over the marked tickets at its front. Marks and hand-back index are sequentially consistent,
+    // so of two readers marking neighbouring tickets at least one sees the other's mark and moves on.
+    static void hand_back(std::atomic<uint32_t> &done, std::atomic<uint32_t> *marks) noexcept
+    {
+        for (auto cur_rd = done.load(std::memory_order_seq_cst);
+             marks[cur_rd % ClaimWindow].load(std::memory_order_seq_cst) == cur_rd + 1;)
+        {
+            if (done.compare_exchange_weak(cur_rd, cur_rd + 1, std::memory_order_seq_cst, std::memory_order_seq_cst))
+            {
+                ++cur_rd;
+            }
+        }
+    }
+
+    // The only reader of a conflating ring takes a slot off its committed sequence before reading it,
+    // so a writer can no longer rewrite it. The slot stays taken until the next lap reuses it.
+    template <typename W, typename F, typename R, typename Seg>
+    uint32_t pop_taken(W *wrapper, uint32_t prio, uint32_t &cur, uint32_t count, F &&f, R &&out, Seg *seg)
+    {
+        uint32_t n = 0;
+        for (; n < count; ++cur)
+        {
+            auto *el = seg->at(prio, cur);
+            auto seq = stamp_of(cur);
+            if (!el->seq_.compare_exchange_strong(seq, taken_of(cur), std::memory_order_acq_rel, std::memory_order_relaxed))
+            {
+                break; // empty, or a writer is filling or rewriting it
+            }
+            f(n, &(el->data_), cur);
+            out(n++);
+        }
+        if (n)
+        {
+            reader_of(wrapper->connected_id()).cursor_[prio].store(cur, std::memory_order_release);
+        }
+        return n;
+    }
+
+    // Sequence a writer commits `ticket` with.
+    uint32_t commit_of(uint32_t ticket) const noexcept
+    {
+        return conflate_ ? stamp_of(ticket) : ticket + 1;
+    }
+
+    // Sequence of a taken slot of a conflating ring. It is odd, so no writer ever takes it for a commit,
+    // of this lap or of any other one.
+    static constexpr uint32_t taken_of(uint32_t ticket) noexcept
+    {
+        return stamp_of(ticket) + 1;
+    }
+
+    static constexpr uint32_t hash_of(uint64_t key) noexcept
+    {
+        return static_cast<uint32_t>((key * 0x9E3779B97F4A7C15ull) >> 32);
+    }
+
+    static constexpr bool is_sender(uint32_t cc_id) noexcept
+    {
+        return (cc_id > 0) && (cc_id <= (MAX_CONNECTIONS / 2));
+    }
+
+    static constexpr bool is_reader(uint32_t cc_id) noexcept
+    {
+        return (cc_id > (MAX_CONNECTIONS / 2)) && (cc_id <= MAX_CONNECTIONS);
+    }
+
+    group_t *group_of(uint32_t cc_id) noexcept
+    {
+        if (!is_reader(cc_id))
+        {
+            return nullptr;
+        }
+        auto group = reader_of(cc_id).group_.load(std::memory_order_acquire);
+        return group ? &groups_[group - 1] : nullptr;
+    }
+
+    reader_t &reader_of(uint32_t cc_id) noexcept
+    {
+        return readers_[cc_id - 1 - (MAX_CONNECTIONS / 2)];
+    }
+
+    bool reserve(uint32_t prio, uint32_t count, uint32_t capacity, uint32_t &cur_wt) noexcept;
+
+    // Moves the base of a ring on when w_ went from `from` to `to` across a multiple of 2^30,
+    // so the base stays well within 2^31 of every ticket a reader can still get.
+    static void advance(ring_t &ring, uint32_t from, uint32_t to) noexcept
+    {
+        if ((from ^ to) >> 30)
+        {
+            ring.base_.store(extend(ring.base_.load(std::memory_order_relaxed), to), std::memory_order_release);
+        }
+    }
+
+    bool refresh(uint32_t prio) noexcept;
+
 private:
-    alignas(Align) std::atomic<uint32_t> r_; // read index
-    alignas(Align) std::atomic<uint32_t> w_; // write index
+    ring_t rings_[MaxPriorities];
+    reader_t readers_[MAX_CONNECTIONS / 2];
+    std::atomic<uint32_t> epochs_[MAX_CONNECTIONS / 2]{};
+    group_t groups_[MaxGroups];
+    alignas(Align) std::atomic<uint32_t> roster_{0};
+
+    // number of rings in use, one per priority class
+    uint32_t priorities_ = 1;
+
+    // per-sender rings, only used when the channel was created with lanes
+    bool use_lanes_ = false;
+    // lanes, chained and conflating rings refuse a second reader
+    bool single_reader_ = false;
+    // readers share the claim index of every ring, each message reaches one of them
+    bool competing_ = false;
+    // writers overwrite the oldest slots instead of waiting for slow readers
+    bool overwrite_ = false;
+    // keyed messages replace the unread one of their key in place
+    bool conflate_ = false;
+    // messages kept behind the slowest reader for readers to seek back to
+    uint32_t retain_ = 0;
+    uint32_t capacity_ = 0;
+    uint32_t next_lane_ = 0; // where the only reader resumes its round-robin
+    lane_t lanes_[MAX_CONNECTIONS / 2];
 };
 
 } // namespace detail
@@ -26,7 +26,7 @@ public:
     Head &operator=(Head const &) = delete;
 
 public:
-    void init()
+    void init(Options const &options, std::uint32_t stride)
     {
         if (!constructed_.load(std::memory_order_acquire))
         {
@@ -34,12 +34,26 @@ public:
             if (!constructed_.load(std::memory_order_relaxed))
             {
                 ::new (this) Head;
+                options_ = options;
+                stride_ = stride;
+                ctx_.init(options);
                 waiter_.init();
+                space_.init();
                 constructed_.store(true, std::memory_order_release);
             }
         }
     }
 
+    bool constructed() const noexcept
+    {
+        return constructed_.load(std::memory_order_acquire);
+    }
+
+    Options const &options() const noexcept
+    {
+        return options_;
+    }
+
     uint32_t connections() noexcept
     {
         return base_t::ctx_.connections();
@@ -60,6 +74,46 @@ public:
         return base_t::ctx_.recv_count();
     }
 
+    uint32_t consumers() noexcept
+    {
+        return base_t::ctx_.consumers();
+    }
+
+    uint32_t consumers(uint32_t prio, cursor_t ticket) noexcept
+    {
+        return base_t::ctx_.consumers(prio, ticket);
+    }
+
+    uint32_t roster() const noexcept
+    {
+        return base_t::ctx_.roster();
+    }
+
+    bool orphans(uint32_t cc_id) noexcept
+    {
+        return base_t::ctx_.orphans(cc_id);
+    }
+
+    uint32_t claim_dead() noexcept
+    {
+        return base_t::ctx_.claim_dead();
+    }
+
+    bool join(uint32_t cc_id, char const *group) noexcept
+    {
+        return base_t::ctx_.join(cc_id, group);
+    }
+
+    bool seek(uint32_t cc_id, std::uint32_t prio, cursor_t ticket) noexcept
+    {
+        return base_t::ctx_.seek(cc_id, prio, ticket);
+    }
+
+    std::uint64_t sequence(std::uint32_t prio, cursor_t ticket) const noexcept
+    {
+        return base_t::ctx_.sequence(prio, ticket);
+    }
+
     cursor_t rd() const noexcept
     {
         return base_t::ctx_.rd();
@@ -70,14 +124,136 @@ public:
         return base_t::ctx_.wr();
     }
 
+    cursor_t cursor(uint32_t cc_id, std::uint32_t prio = 0) const noexcept
+    {
+        return base_t::ctx_.cursor(cc_id, prio);
+    }
+
+    std::uint32_t epoch(uint32_t cc_id) const noexcept
+    {
+        return base_t::ctx_.epoch(cc_id);
+    }
+
+    std::uint32_t skipped(uint32_t cc_id) const noexcept
+    {
+        return base_t::ctx_.skipped(cc_id);
+    }
+
+    template <typename F>
+    void for_each_reader(F &&f)
+    {
+        base_t::ctx_.for_each_reader(std::forward<F>(f));
+    }
+
+    std::uint32_t capacity() const noexcept
+    {
+        return options_.capacity;
+    }
+
+    // Chained rings: every segment links to the one written after it, by generation + 1 (0: none).
+    // The generations, the segment written to and the one read from are kept in the first segment.
+    std::uint32_t next() const noexcept
+    {
+        return next_.load(std::memory_order_acquire);
+    }
+
+    // Seals the ring and points its reader at generation `gen`, 0 being the first segment.
+    void link(std::uint32_t gen) noexcept
+    {
+        base_t::ctx_.seal(0);
+        next_.store(gen + 1, std::memory_order_release);
+    }
+
+    // Takes the first segment back into use once its reader left it for good.
+    void relink() noexcept
+    {
+        next_.store(0, std::memory_order_relaxed);
+        base_t::ctx_.unseal(0);
+    }
+
+    bool drained(cursor_t cur) const noexcept
+    {
+        return (next() != 0) && base_t::ctx_.drained(0, cur);
+    }
+
+    std::uint32_t generate() noexcept
+    {
+        return gens_.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    std::atomic<std::uint32_t> &tail() noexcept
+    {
+        return tail_;
+    }
+
+    std::atomic<std::uint32_t> &head() noexcept
+    {
+        return head_;
+    }
+
+    std::atomic<bool> &vacant() noexcept
+    {
+        return vacant_;
+    }
+
+    SpinLock &chain_lock() noexcept
+    {
+        return chain_lc_;
+    }
+
+    std::uint32_t stride() const noexcept
+    {
+        return stride_;
+    }
+
     inline Waiter &waiter() noexcept
     {
         return waiter_;
     }
 
+    inline Waiter &space() noexcept
+    {
+        return space_;
+    }
+
+    // Parks a writer while `full` holds, which is evaluated under the lock of the space waiter.
+    template <typename F>
+    bool wait_space(F &&full, std::uint64_t tm) noexcept
+    {
+        blocked_.fetch_add(1, std::memory_order_seq_cst);
+        auto ret = space_.wait_while(std::forward<F>(full), tm);
+        blocked_.fetch_sub(1, std::memory_order_relaxed);
+        return ret;
+    }
+
+    // Called by readers after they moved their cursors, costs one load while no writer is parked.
+    void space_freed() noexcept
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (blocked_.load(std::memory_order_relaxed))
+        {
+            space_.broadcast_locked();
+        }
+    }
+
 protected:
     Waiter waiter_;
+    // writers waiting for a free slot
+    Waiter space_;
+    std::atomic<std::uint32_t> blocked_{0};
     Content ctx_;
+    // settings of the creator, adopted by every later endpoint
+    Options options_;
+    // bytes between two ring slots
+    std::uint32_t stride_ = 0;
+
+    // chained rings
+    std::atomic<std::uint32_t> next_{0};
+    std::atomic<std::uint32_t> gens_{0};
+    std::atomic<std::uint32_t> tail_{0}; // generation the writers fill
+    std::atomic<std::uint32_t> head_{0}; // generation the reader drains
+    std::atomic<bool> vacant_{false};    // the reader left the first segment, writers may return to it
+    SpinLock chain_lc_;
 
     // init
     SpinLock lc_;
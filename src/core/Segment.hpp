@@ -1,11 +1,14 @@
 #ifndef _IPC_CORE_ELEMARRAY_H_
 #define _IPC_CORE_ELEMARRAY_H_
 
+#include <algorithm>
 #include <atomic>
-#include <limits>
+#include <cstddef>
 #include <utility>
 #include <type_traits>
+#include <config.h>
 #include <core/Head.hpp>
+#include <core/Content.h>
 
 namespace ipc
 {
@@ -20,23 +23,103 @@ class Segment : public Head<Content>
 public:
     using cursor_t = decltype(std::declval<Content>().rd());
     using elem_t   = typename Content::template elem_t<DataSize, AlignSize>;
+    using keyed_t  = typename Content::keyed_t;
+
+    static_assert(alignof(Head<Content>) % alignof(elem_t) == 0, "The ring must start aligned right after the head.");
+    static_assert(sizeof(Head<Content>) % Align == 0, "Padded slots must start on a cache line.");
 
 public:
+    // Bytes between two ring slots, the descriptor slot followed by the inline payload area and the user header.
+    // The ring starts on a cache line (the head is cache line aligned), so padded slots never straddle two.
+    static constexpr std::size_t stride_of(Options const &options) noexcept
+    {
+        std::size_t const align = options.padded ? (std::max)(alignof(elem_t), std::size_t{Align}) : alignof(elem_t);
+        return ((sizeof(elem_t) + options.inline_size + options.header_size + align - 1) / align) * align;
+    }
+
+    // Shared memory bytes needed by a segment with the given settings.
+    static constexpr std::size_t size_of(Options const &options) noexcept
+    {
+        return sizeof(Segment) + stride_of(options) * options.capacity * rings_of(options) +
+               (options.conflate ? sizeof(keyed_t) * options.capacity : 0);
+    }
+
+    // Number of rings behind the head, one per sender slot when the channel uses lanes,
+    // one per priority class otherwise.
+    static constexpr std::size_t rings_of(Options const &options) noexcept
+    {
+        return options.lanes ? (MAX_CONNECTIONS / 2) : options.priorities;
+    }
+
+    void init(Options const &options)
+    {
+        Head<Content>::init(options, static_cast<std::uint32_t>(stride_of(options)));
+    }
+
+    // Inline payload area of the slot holding the descriptor at `data`.
+    static void *extra(void *data) noexcept
+    {
+        return reinterpret_cast<elem_t *>(static_cast<char *>(data) - offsetof(elem_t, data_)) + 1;
+    }
+
+    template <typename Q, typename F>
+    bool push(Q* que, std::uint32_t prio, F&& f)
+    {
+        return Head<Content>::base_t::ctx_.push(que, prio, std::forward<F>(f), this);
+    }
 
     template <typename Q, typename F>
-    bool push(Q* que, F&& f)
+    bool push_keyed(Q*, std::uint32_t prio, std::uint64_t key, F&& f)
     {
-        return Head<Content>::base_t::ctx_.push(que, std::forward<F>(f), block_);
+        return Head<Content>::base_t::ctx_.push_keyed(prio, key, std::forward<F>(f), this);
+    }
+
+    template <typename Q, typename F>
+    bool push_n(Q* que, std::uint32_t prio, std::uint32_t count, F&& f)
+    {
+        return Head<Content>::base_t::ctx_.push_n(que, prio, count, std::forward<F>(f), this);
+    }
+
+    template <typename Q, typename F, typename R>
+    bool pop(Q* que, std::uint32_t prio, cursor_t &cur, F&& f, R&& out)
+    {
+        return Head<Content>::base_t::ctx_.pop(que, prio, cur, std::forward<F>(f), std::forward<R>(out), this);
     }
 
     template <typename Q, typename F, typename R>
-    bool pop(Q* que, cursor_t &cur, F&& f, R&& out)
+    std::uint32_t pop_n(Q* que, std::uint32_t prio, cursor_t &cur, std::uint32_t count, F&& f, R&& out)
     {
-        return Head<Content>::base_t::ctx_.pop(que, cur, std::forward<F>(f), std::forward<R>(out), block_);
+        return Head<Content>::base_t::ctx_.pop_n(que, prio, cur, count, std::forward<F>(f), std::forward<R>(out), this);
+    }
+
+    // The ring lives right behind the segment, its geometry is only known at runtime.
+    elem_t *at(cursor_t cur) noexcept
+    {
+        return slot(static_cast<std::size_t>(cur & (Head<Content>::capacity() - 1)));
+    }
+
+    // Slot of one of the rings, the private ring of a sender or the ring of a priority class.
+    // Rings are laid out back to back.
+    elem_t *at(std::uint32_t lane, cursor_t cur) noexcept
+    {
+        return slot(static_cast<std::size_t>(lane) * Head<Content>::capacity() +
+                    static_cast<std::size_t>(cur & (Head<Content>::capacity() - 1)));
+    }
+
+    // Key table of a conflating ring, right behind the rings.
+    // A ring spans a multiple of 256 bytes (at least 64 slots of 4 byte multiples), so the table stays aligned.
+    keyed_t *keyed(cursor_t index) noexcept
+    {
+        auto const &options = Head<Content>::options();
+        return reinterpret_cast<keyed_t *>(reinterpret_cast<char *>(this + 1) +
+                                           Head<Content>::stride() * options.capacity * rings_of(options)) + index;
     }
 
 private:
-    elem_t block_[(std::numeric_limits<uint8_t>::max)() + 1] {};
+    elem_t *slot(std::size_t index) noexcept
+    {
+        return reinterpret_cast<elem_t *>(reinterpret_cast<char *>(this + 1) + index * Head<Content>::stride());
+    }
 };
 
 } // namespace detail
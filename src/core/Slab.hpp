@@ -0,0 +1,135 @@
+#ifndef _IPC_CORE_SLAB_H_
+#define _IPC_CORE_SLAB_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace ipc
+{
+namespace detail
+{
+
+////////////////////////////////////////////////////////////////
+/// Size-class allocator over a block of shared memory.
+/// Requests are rounded up to a power of two, a freed block goes onto the
+/// free list of its class and is handed out again before the untouched
+/// rest of the block, so memory in use follows what is in flight.
+/// Its state lives at the start of the block. Only the sender owning a
+/// payload pool allocates and frees, readers merely count down the
+/// reference in front of a payload, so it does no locking of its own.
+////////////////////////////////////////////////////////////////
+
+class Slab
+{
+public:
+    // Smallest block, keeps the free list link clear of the reference count at the front of a payload.
+    static constexpr std::size_t MinBlock = 64;
+    // Size classes, 64 bytes up to 2 GiB.
+    static constexpr std::uint32_t Classes = 26;
+
+    Slab(void *base, std::size_t size) noexcept
+        : head_{static_cast<head_t *>(base)}
+        , base_{static_cast<char *>(base)}
+        , size_{size}
+    {
+        // a pool belongs to one sender slot and epoch, so a new owner always starts from scratch
+        std::memset(head_, 0, sizeof(head_t));
+        head_->top_ = sizeof(head_t);
+    }
+
+    Slab(Slab const &) = delete;
+    Slab &operator=(Slab const &) = delete;
+
+public:
+    // Returns nullptr once neither a free block of the class nor room behind the used part is left.
+    void *allocate(std::size_t size) noexcept
+    {
+        auto const cls = class_of(size);
+        if (cls >= Classes)
+        {
+            return nullptr;
+        }
+        auto const block = block_of(cls);
+        if (auto off = head_->free_[cls])
+        {
+            auto *p = base_ + off;
+            head_->free_[cls] = link_of(p);
+            head_->used_ += block;
+            return p;
+        }
+        if (head_->top_ + block > size_)
+        {
+            return nullptr;
+        }
+        auto *p = base_ + head_->top_;
+        head_->top_ += block;
+        head_->used_ += block;
+        return p;
+    }
+
+    // `size` must be the one the block was allocated with.
+    void deallocate(void *p, std::size_t size) noexcept
+    {
+        auto const cls = class_of(size);
+        if ((p == nullptr) || (cls >= Classes))
+        {
+            return;
+        }
+        link_of(p) = head_->free_[cls];
+        head_->free_[cls] = static_cast<std::uint64_t>(static_cast<char *>(p) - base_);
+        head_->used_ -= block_of(cls);
+    }
+
+    // Bytes in blocks handed out and not freed yet.
+    std::size_t used() const noexcept
+    {
+        return static_cast<std::size_t>(head_->used_);
+    }
+
+    // Bytes of the block ever carved into blocks, the high-water mark of used().
+    std::size_t reserved() const noexcept
+    {
+        return static_cast<std::size_t>(head_->top_ - sizeof(head_t));
+    }
+
+    static constexpr std::size_t block_of(std::uint32_t cls) noexcept
+    {
+        return MinBlock << cls;
+    }
+
+    static constexpr std::uint32_t class_of(std::size_t size) noexcept
+    {
+        std::uint32_t cls = 0;
+        while ((cls < Classes) && (block_of(cls) < size))
+        {
+            ++cls;
+        }
+        return cls;
+    }
+
+private:
+    // Offsets are taken from the start of the block, 0 ends a free list since the head sits there.
+    struct alignas(64) head_t
+    {
+        std::uint64_t top_;
+        std::uint64_t used_;
+        std::uint64_t free_[Classes];
+    };
+
+    // A free block keeps the offset of the next one of its class behind the reference count of its payload.
+    static std::uint64_t &link_of(void *p) noexcept
+    {
+        return *reinterpret_cast<std::uint64_t *>(static_cast<char *>(p) + sizeof(std::uint64_t));
+    }
+
+private:
+    head_t *head_;
+    char *base_;
+    std::size_t size_;
+};
+
+} // namespace detail
+} // namespace ipc
+
+#endif // ! _IPC_CORE_SLAB_H_
@@ -0,0 +1,73 @@
+#ifndef _IPC_SYNC_SEQLOCK_H_
+#define _IPC_SYNC_SEQLOCK_H_
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include <sync/RwLock.h>
+
+namespace ipc
+{
+namespace detail
+{
+
+////////////////////////////////////////////////////////////////
+/// Sequence lock, lives in shared memory.
+/// Readers never block writers: they copy optimistically and retry
+/// when a write overlapped, an odd sequence marks a write in progress.
+////////////////////////////////////////////////////////////////
+
+class SeqLock
+{
+    std::atomic<std::uint32_t> seq_{0};
+
+public:
+    // Writers exclude each other by moving the sequence from even to odd.
+    template <typename F>
+    void write(F &&f) noexcept
+    {
+        auto seq = seq_.load(std::memory_order_relaxed);
+        for (unsigned k = 0;; yield(k))
+        {
+            if (!(seq & 1) &&
+                seq_.compare_exchange_weak(seq, seq + 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+            {
+                break;
+            }
+            seq = seq_.load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        std::forward<F>(f)();
+        seq_.store(seq + 2, std::memory_order_release);
+    }
+
+    // Returns the (even) sequence the copy made by f is consistent with.
+    template <typename F>
+    std::uint32_t read(F &&f) const noexcept
+    {
+        for (unsigned k = 0;; yield(k))
+        {
+            auto seq = seq_.load(std::memory_order_acquire);
+            if (seq & 1)
+            {
+                continue; // a write is in progress
+            }
+            f();
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq_.load(std::memory_order_relaxed) == seq)
+            {
+                return seq;
+            }
+        }
+    }
+
+    std::uint32_t sequence() const noexcept
+    {
+        return seq_.load(std::memory_order_acquire);
+    }
+};
+
+} // namespace detail
+} // namespace ipc
+
+#endif // ! _IPC_SYNC_SEQLOCK_H_
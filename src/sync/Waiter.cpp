@@ -35,11 +35,29 @@ void Waiter::close() noexcept
 
 bool Waiter::notify() noexcept
 {
+    notified_.fetch_add(1, std::memory_order_seq_cst);
+    if (!waiting_.load(std::memory_order_seq_cst))
+    {
+        return true;
+    }
+    std::lock_guard<Mutex> guard{ mutex_ };
     return cond_.notify(mutex_);
 }
 
 bool Waiter::broadcast() noexcept
 {
+    notified_.fetch_add(1, std::memory_order_seq_cst);
+    if (!waiting_.load(std::memory_order_seq_cst))
+    {
+        return true;
+    }
+    std::lock_guard<Mutex> guard{ mutex_ };
+    return cond_.broadcast(mutex_);
+}
+
+bool Waiter::broadcast_locked() noexcept
+{
+    std::lock_guard<Mutex> guard{ mutex_ };
     return cond_.broadcast(mutex_);
 }
 
@@ -25,28 +25,60 @@ public:
 
     void close() noexcept;
 
+    // Wake the threads parked in wait_for, cost an increment and a load while none is.
     bool notify() noexcept;
 
     bool broadcast() noexcept;
 
     bool quit();
 
+    // Runs `pred`, then parks for up to `tm` ms and runs it again. `pred` never runs under the mutex,
+    // so it may notify this waiter itself. The waiter registers and samples the notify count before
+    // running `pred`, and only parks if no notify() came in since, so none of them is lost.
     template <typename F>
     void wait_for(F &&pred, std::uint64_t tm = static_cast<uint64_t>(TimeOut::DEFAULT_TIMEOUT)) noexcept
     {
-        std::lock_guard<Mutex> guard{ mutex_ };
-        if (tm && !cond_.wait(mutex_, tm))
+        if (!tm)
         {
-            // std::cerr << "Condition wait has a error." << std::endl;
+            std::forward<F>(pred)();
             return;
         }
+        waiting_.fetch_add(1, std::memory_order_seq_cst);
+        auto seen = notified_.load(std::memory_order_seq_cst);
+        pred();
+        {
+            std::lock_guard<Mutex> guard{ mutex_ };
+            if (notified_.load(std::memory_order_seq_cst) == seen)
+            {
+                cond_.wait(mutex_, tm);
+            }
+        }
+        waiting_.fetch_sub(1, std::memory_order_relaxed);
+        std::forward<F>(pred)();
+    }
 
-        std::forward<F>(pred)(); 
+    // Checks `pred` under the mutex and waits once while it holds, pairs with broadcast_locked.
+    // Returns false on a timeout.
+    template <typename F>
+    bool wait_while(F &&pred, std::uint64_t tm = static_cast<uint64_t>(TimeOut::DEFAULT_TIMEOUT)) noexcept
+    {
+        std::lock_guard<Mutex> guard{ mutex_ };
+        if (!std::forward<F>(pred)())
+        {
+            return true;
+        }
+        return cond_.wait(mutex_, tm);
     }
 
+    bool broadcast_locked() noexcept;
+
 private:
     Mutex mutex_;
     Condition cond_;
+    // threads in wait_for
+    std::atomic<std::uint32_t> waiting_{0};
+    // bumped by every notify() and broadcast()
+    std::atomic<std::uint32_t> notified_{0};
 };
 
 } // namespace detail
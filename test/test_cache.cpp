@@ -0,0 +1,315 @@
+#include <cstring>
+#include <set>
+#include <string>
+#include <vector>
+#include <ipc/Buffer.h>
+#include <Descriptor.h>
+#include <core/Cache.hpp>
+#include <core/Slab.hpp>
+#include <core/BipBuffer.hpp>
+
+#include "test.h"
+
+using namespace ipc;
+using namespace ipc::detail;
+
+TEST(Cache, descriptor) {
+    EXPECT_EQ(sizeof(Descriptor), 16u);
+    EXPECT_TRUE(Descriptor{}.is_inline());
+    EXPECT_FALSE((Descriptor{3, 64, 5, 1}.is_inline()));
+}
+
+TEST(Cache, producer_slots) {
+    Cache<SENDER> first, second;
+    ASSERT_FALSE(first.init("cache-slots", 0, 0));
+    ASSERT_TRUE(first.init("cache-slots", 1, 1));
+    ASSERT_TRUE(second.init("cache-slots", 2, 1));
+    Cache<RECEIVER> reader;
+    ASSERT_TRUE(reader.init("cache-slots", 0, 0));
+
+    std::string const text = "seven b";
+    auto desc = first.write(text.data(), text.size(), 1);
+    EXPECT_EQ(desc.producer(), 1u);
+    EXPECT_EQ(desc.epoch(), 1u);
+    EXPECT_EQ(desc.length(), text.size());
+
+    std::string got;
+    EXPECT_TRUE(reader.read(desc, [&got](ipc::Buffer const * buf) {
+        got.assign(static_cast<char const *>(buf->data()), buf->size());
+    }));
+    EXPECT_EQ(got, text);
+
+    // the same slot taken over by a later sender resolves to the new pool
+    Cache<SENDER> later;
+    ASSERT_TRUE(later.init("cache-slots", 1, 2));
+    auto next = later.write("other", 5, 1);
+    EXPECT_TRUE(reader.read(next, [&got](ipc::Buffer const * buf) {
+        got.assign(static_cast<char const *>(buf->data()), buf->size());
+    }));
+    EXPECT_EQ(got, "other");
+
+    EXPECT_FALSE(reader.read(Descriptor{40, 0, 4, 1}, [](ipc::Buffer const *) {}));
+}
+
+TEST(Cache, slab) {
+    std::vector<char> mem(1024 * 1024);
+    Slab slab(mem.data(), mem.size());
+    EXPECT_EQ(Slab::class_of(1), 0u);
+    EXPECT_EQ(Slab::class_of(64), 0u);
+    EXPECT_EQ(Slab::class_of(65), 1u);
+
+    // a freed block is handed out again before fresh memory is carved
+    auto *a = slab.allocate(100);
+    auto *b = slab.allocate(100);
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+    EXPECT_EQ(slab.used(), 256u);
+    slab.deallocate(a, 100);
+    EXPECT_EQ(slab.allocate(120), a);
+    EXPECT_EQ(slab.reserved(), 256u);
+
+    // other classes keep their own free lists
+    auto *c = slab.allocate(1000);
+    slab.deallocate(c, 1000);
+    EXPECT_NE(slab.allocate(64), c);
+    EXPECT_EQ(slab.allocate(1024), c);
+
+    // out of room
+    EXPECT_EQ(slab.allocate(mem.size()), nullptr);
+}
+
+TEST(Cache, bounded_pool) {
+    Cache<SENDER> writer;
+    ASSERT_TRUE(writer.init("cache-bounded", 1, 1));
+    Cache<RECEIVER> reader;
+    ASSERT_TRUE(reader.init("cache-bounded", 0, 0));
+
+    // far more bytes than the pool holds go through it, as long as the reader keeps up
+    std::vector<char> payload(1024 * 1024, 'x');
+    for (int i = 0; i < 2048; ++i) {
+        auto desc = writer.write(payload.data(), payload.size(), 1);
+        ASSERT_TRUE(desc.length()) << i;
+        EXPECT_TRUE(reader.read(desc, [](ipc::Buffer const *) {}));
+    }
+}
+
+TEST(Cache, bip_buffer) {
+    std::vector<char> mem(64 + 1024);
+    BipBuffer ring(mem.data(), mem.size());
+    EXPECT_EQ(ring.capacity(), 1024u);
+
+    // blocks are carved back to back, 80 bytes are left in front of the end
+    std::vector<void *> blocks;
+    for (auto size : {200, 200, 200, 200, 100}) {
+        blocks.push_back(ring.allocate(size));
+        ASSERT_NE(blocks.back(), nullptr);
+    }
+    EXPECT_EQ(static_cast<char *>(blocks[1]) - static_cast<char *>(blocks[0]), 208);
+    EXPECT_EQ(ring.used(), 944u);
+
+    std::set<void *> done;
+    auto gone = [&done](void *p) { return done.count(p) > 0; };
+
+    // the tail stops at the first block still in use, whatever comes behind it
+    done.insert(blocks[1]);
+    ring.reclaim(gone);
+    EXPECT_EQ(ring.used(), 944u);
+    EXPECT_EQ(ring.allocate(200), nullptr);
+
+    done = {blocks[0], blocks[1]};
+    ring.reclaim(gone);
+    EXPECT_EQ(ring.used(), 528u);
+    // too big for the rest in front of the end, it wraps to the start
+    done.clear();
+    auto *wrapped = ring.allocate(300);
+    EXPECT_EQ(wrapped, blocks[0]);
+    EXPECT_EQ(ring.used(), 912u);
+    EXPECT_EQ(ring.allocate(200), nullptr);
+
+    // the skipped end goes together with the block in front of it
+    done = {blocks[2], blocks[3], blocks[4]};
+    ring.reclaim(gone);
+    EXPECT_EQ(ring.used(), 304u);
+    ring.reclaim([](void *) { return true; });
+    EXPECT_EQ(ring.used(), 0u);
+    EXPECT_EQ(ring.allocate(1000), blocks[0]);
+}
+
+TEST(Cache, fifo_pool) {
+    Options options;
+    options.fifo_pool = true;
+    Cache<SENDER> writer(options);
+    ASSERT_TRUE(writer.init("cache-fifo", 1, 1));
+    Cache<RECEIVER> reader;
+    ASSERT_TRUE(reader.init("cache-fifo", 0, 0));
+
+    // payloads given back in order keep the ring turning over
+    std::vector<char> payload(1024 * 1024, 'x');
+    for (int i = 0; i < 2048; ++i) {
+        payload[0] = static_cast<char>(i);
+        auto desc = writer.write(payload.data(), payload.size(), 1);
+        ASSERT_TRUE(desc.length()) << i;
+        char first = 0;
+        EXPECT_TRUE(reader.read(desc, [&first](ipc::Buffer const * buf) {
+            first = *static_cast<char const *>(buf->data());
+        }));
+        EXPECT_EQ(first, static_cast<char>(i));
+    }
+
+    // a payload that is never read only holds back its own ring, later writes go to the other extents
+    payload[0] = 'h';
+    auto held = writer.write(payload.data(), payload.size(), 1);
+    ASSERT_TRUE(held.length());
+    payload[0] = 'x';
+    for (int i = 0; i < 2048; ++i) {
+        ASSERT_TRUE(writer.write(payload.data(), payload.size(), 0).length()) << i;
+    }
+    char first = 0;
+    EXPECT_TRUE(reader.read(held, [&first](ipc::Buffer const * buf) {
+        first = *static_cast<char const *>(buf->data());
+    }));
+    EXPECT_EQ(first, 'h');
+}
+
+TEST(Cache, extents) {
+    Options options;
+    options.pool_size = 4 * 1024 * 1024;
+    Cache<SENDER> writer(options);
+    ASSERT_TRUE(writer.init("cache-extents", 1, 1));
+    Cache<RECEIVER> reader;
+    ASSERT_TRUE(reader.init("cache-extents", 0, 0));
+    EXPECT_EQ(writer.extents(), 1u);
+    EXPECT_EQ(extent_of(0), 0u);
+    EXPECT_EQ(extent_of(1024 * 1024), 1u);
+    EXPECT_EQ(extent_of(3 * 1024 * 1024), 2u);
+
+    // a single payload may take up to half the pool
+    void *data = nullptr;
+    EXPECT_FALSE(writer.loan(2 * 1024 * 1024 + 1, data).length());
+    EXPECT_EQ(data, nullptr);
+
+    // extents of 1, 2 and 1 MiB are mapped one by one as unread payloads pile up, then the pool is full
+    std::vector<char> payload(200 * 1024);
+    std::vector<Descriptor> held;
+    for (char i = 0;; ++i) {
+        payload[0] = i;
+        auto desc = writer.write(payload.data(), payload.size(), 1);
+        if (!desc.length()) {
+            break;
+        }
+        held.push_back(desc);
+        ASSERT_LT(held.size(), 64u);
+    }
+    EXPECT_EQ(writer.extents(), 3u);
+    EXPECT_EQ(held.size(), 13u);
+    EXPECT_EQ(extent_of(held.back().offset()), 2u);
+
+    // the reader maps every extent the first time it meets a payload in there
+    for (std::size_t i = 0; i < held.size(); ++i) {
+        char first = -1;
+        EXPECT_TRUE(reader.read(held[i], [&first](ipc::Buffer const * buf) {
+            first = *static_cast<char const *>(buf->data());
+        }));
+        EXPECT_EQ(first, static_cast<char>(i));
+    }
+    EXPECT_TRUE(writer.write(payload.data(), payload.size(), 1).length());
+}
+
+TEST(Cache, loan) {
+    Cache<SENDER> writer;
+    ASSERT_TRUE(writer.init("cache-loan", 1, 1));
+    Cache<RECEIVER> reader;
+    ASSERT_TRUE(reader.init("cache-loan", 0, 0));
+
+    // the payload is filled in place, the reader sees exactly those bytes
+    void *data = nullptr;
+    auto desc = writer.loan(4096, data);
+    ASSERT_NE(data, nullptr);
+    EXPECT_EQ(desc.length(), 4096u);
+    std::memset(data, 'l', 4096);
+    writer.commit(desc, 2);
+    for (int i = 0; i < 2; ++i) {
+        std::string got;
+        reader.read(desc, [&got](ipc::Buffer const * buf) {
+            got.assign(static_cast<char const *>(buf->data()), buf->size());
+        });
+        EXPECT_EQ(got, std::string(4096, 'l'));
+    }
+
+    // an open loan is never reclaimed, however many writes go by
+    auto held = writer.loan(100, data);
+    ASSERT_NE(data, nullptr);
+    std::memset(data, 'h', 100);
+    char payload[100] = {};
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(writer.write(payload, sizeof(payload), 0).length());
+    }
+    writer.commit(held, 1);
+    std::string got;
+    EXPECT_TRUE(reader.read(held, [&got](ipc::Buffer const * buf) {
+        got.assign(static_cast<char const *>(buf->data()), buf->size());
+    }));
+    EXPECT_EQ(got, std::string(100, 'h'));
+}
+
+TEST(Cache, held_payload) {
+    Cache<SENDER> writer;
+    ASSERT_TRUE(writer.init("cache-held", 1, 1));
+    Cache<RECEIVER> reader;
+    ASSERT_TRUE(reader.init("cache-held", 0, 0));
+
+    // a payload still referenced is never handed out again, however many sweeps go by
+    std::string const text(100, 'h');
+    auto held = writer.write(text.data(), text.size(), 1);
+    ASSERT_TRUE(held.length());
+    char payload[100] = {};
+    for (int i = 0; i < 1000; ++i) {
+        auto desc = writer.write(payload, sizeof(payload), 1);
+        ASSERT_NE(desc.offset(), held.offset());
+        EXPECT_TRUE(reader.read(desc, [](ipc::Buffer const *) {}));
+    }
+    std::string got;
+    EXPECT_TRUE(reader.read(held, [&got](ipc::Buffer const * buf) {
+        got.assign(static_cast<char const *>(buf->data()), buf->size());
+    }));
+    EXPECT_EQ(got, text);
+
+    // and it is still tracked, the next sweeps take it back once the last reference is gone
+    auto first = writer.write(payload, sizeof(payload), 1);
+    auto second = writer.write(payload, sizeof(payload), 1);
+    EXPECT_TRUE((first.offset() == held.offset()) || (second.offset() == held.offset()));
+}
+
+namespace {
+
+// Average time of a write and read while `backlog` payloads nobody reads are in flight.
+double write_with_backlog(char const *name, int backlog) {
+    constexpr int LoopCount = 20000;
+    Cache<SENDER> writer;
+    EXPECT_TRUE(writer.init(name, 1, 1));
+    Cache<RECEIVER> reader;
+    EXPECT_TRUE(reader.init(name, 0, 0));
+    char payload[64] = {};
+    for (int i = 0; i < backlog; ++i) {
+        EXPECT_TRUE(writer.write(payload, sizeof(payload), 1).length());
+    }
+
+    ipc_ut::test_stopwatch sw;
+    sw.start();
+    for (int i = 0; i < LoopCount; ++i) {
+        auto desc = writer.write(payload, sizeof(payload), 1);
+        EXPECT_TRUE(reader.read(desc, [](ipc::Buffer const *) {}));
+    }
+    auto message = std::to_string(backlog) + " in flight";
+    sw.print_elapsed(1, 1, LoopCount, message.c_str());
+    return double(sw.sw_.elapsed<std::chrono::nanoseconds>()) / LoopCount;
+}
+
+} // internal-linkage
+
+TEST(Cache, reclaim_backlog) {
+    // every write reclaims a bounded number of payloads, so a deep backlog barely slows it down
+    auto shallow = write_with_backlog("cache-backlog-s", 100);
+    auto deep = write_with_backlog("cache-backlog-d", 10000);
+    EXPECT_LT(deep, shallow * 10);
+}
@@ -0,0 +1,420 @@
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <ipc/Ipc.h>
+#include <ipc/Buffer.h>
+
+#include "test.h"
+
+using namespace ipc;
+
+namespace {
+
+// Keeps every message a reader gets, in order.
+class collector : public Callback {
+public:
+    void message_arrived(Buffer const * buf) override {
+        std::lock_guard<std::mutex> guard {lock_};
+        got_.emplace_back(static_cast<char const *>(buf->data()), buf->size());
+    }
+
+    std::vector<std::string> got() {
+        std::lock_guard<std::mutex> guard {lock_};
+        return got_;
+    }
+
+    std::size_t size() {
+        std::lock_guard<std::mutex> guard {lock_};
+        return got_.size();
+    }
+
+private:
+    std::mutex lock_;
+    std::vector<std::string> got_;
+};
+
+// Keeps the messages whose user header holds an even number, drops the others on the header alone.
+class even_only : public collector {
+public:
+    bool message_filter(Buffer const * header) override {
+        std::uint64_t tag = 0;
+        std::memcpy(&tag, header->data(), sizeof(tag));
+        return (tag % 2) == 0;
+    }
+};
+
+// Keeps the outcome of every write a sender reports.
+class deliveries : public Callback {
+public:
+    void delivery_complete(ErrorCode const & cause) override {
+        std::lock_guard<std::mutex> guard {lock_};
+        got_.push_back(cause);
+    }
+
+    std::vector<ErrorCode> got() {
+        std::lock_guard<std::mutex> guard {lock_};
+        return got_;
+    }
+
+private:
+    std::mutex lock_;
+    std::vector<ErrorCode> got_;
+};
+
+// Writes back into channel `name` through a sender of its own, until `count` messages went through.
+class echo : public collector {
+public:
+    echo(char const * name, std::size_t count)
+        : wr_ {name, SENDER}
+        , count_ {count} {}
+
+    void message_arrived(Buffer const * buf) override {
+        collector::message_arrived(buf);
+        if (size() < count_) {
+            wr_.write(std::to_string(size()));
+        }
+    }
+
+private:
+    Channel wr_;
+    std::size_t count_;
+};
+
+// A reader of channel `name` taking messages in a thread of its own until it is stopped.
+template <typename Que>
+class reader {
+public:
+    reader(char const * name, std::uint64_t tm = 10, Options const & options = {},
+           std::shared_ptr<collector> got = std::make_shared<collector>())
+        : que_ {name, RECEIVER, options}
+        , got_ {std::move(got)} {
+        que_.set_callback(got_);
+        thread_ = std::thread {[this, tm] { que_.read(tm); }};
+    }
+
+    ~reader() {
+        stop();
+    }
+
+    void stop() {
+        if (thread_.joinable()) {
+            que_.disconnect();
+            thread_.join();
+        }
+    }
+
+    // Waits up to a second for `count` messages.
+    bool wait_for(std::size_t count) {
+        for (int i = 0; (i < 1000) && (got_->size() < count); ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return got_->size() >= count;
+    }
+
+    collector & got() noexcept {
+        return *got_;
+    }
+
+private:
+    Que que_;
+    std::shared_ptr<collector> got_;
+    std::thread thread_;
+};
+
+// Buffers over the bytes of `msgs`, which must outlive them.
+std::vector<Buffer> buffers_of(std::vector<std::string> & msgs) {
+    std::vector<Buffer> buffs;
+    for (auto & msg : msgs) {
+        buffs.emplace_back(&msg[0], msg.size());
+    }
+    return buffs;
+}
+
+} // internal-linkage
+
+TEST(Channel, orphaned_payloads) {
+    Options options;
+    options.capacity = 64;
+    options.fifo_pool = true;
+    options.pool_size = static_cast<std::uint32_t>(PoolSize::MIN_POOL_SIZE);
+    Route wr {"channel-orphans", SENDER, options};
+    Route idle {"channel-orphans", RECEIVER};
+    reader<Route> busy {"channel-orphans"};
+
+    std::string payload(800, 'p');
+    for (int i = 0; i < 64; ++i) {
+        ASSERT_TRUE(wr.write(payload));
+    }
+    ASSERT_TRUE(busy.wait_for(64));
+    EXPECT_FALSE(wr.write(payload));
+
+    // a reader leaving next to others gives back the payloads it never read, the pool fills up again
+    idle.disconnect();
+    for (int i = 0; i < 64; ++i) {
+        ASSERT_TRUE(wr.write(payload)) << i;
+    }
+    EXPECT_TRUE(busy.wait_for(128));
+}
+
+TEST(Channel, dead_reader) {
+    Options options;
+    options.capacity = 64;
+    options.pool_size = static_cast<std::uint32_t>(PoolSize::MIN_POOL_SIZE);
+    Route wr {"channel-dead", SENDER, options};
+
+    // a reader in another process goes away without disconnecting, before any thread is started here
+    auto pid = ::fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        Route rd {"channel-dead", RECEIVER};
+        ::_exit(rd.is_connected() ? 0 : 1);
+    }
+    int status = 0;
+    ASSERT_EQ(::waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(WIFEXITED(status) && (WEXITSTATUS(status) == 0));
+
+    // it held a reference to everything written, the ring and the pool still take far more than they hold
+    reader<Route> live {"channel-dead"};
+    std::string payload(800, 'd');
+    for (int i = 0; i < 400; ++i) {
+        ASSERT_TRUE(wr.write(payload)) << i;
+        ASSERT_TRUE(live.wait_for(i + 1)) << i;
+    }
+}
+
+TEST(Channel, wakeup) {
+    Channel wr {"channel-wakeup", SENDER};
+    // a reader parked without a timeout is woken by every message, whenever it comes
+    reader<Channel> rd {"channel-wakeup", static_cast<std::uint64_t>(TimeOut::INVALID_TIMEOUT)};
+    for (int i = 0; i < 200; ++i) {
+        if (i % 50 == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        ASSERT_TRUE(wr.write(std::to_string(i)));
+        ASSERT_TRUE(rd.wait_for(i + 1)) << i;
+    }
+    EXPECT_EQ(rd.got().got().back(), "199");
+}
+
+TEST(Channel, write_from_callback) {
+    Channel wr {"channel-echo", SENDER};
+    // a callback may write into the channel it is reading, in the middle of a wait
+    reader<Channel> rd {"channel-echo", 10, {}, std::make_shared<echo>("channel-echo", 5)};
+    ASSERT_TRUE(wr.write("0"));
+    ASSERT_TRUE(rd.wait_for(5));
+    EXPECT_EQ(rd.got().got(), (std::vector<std::string>{"0", "1", "2", "3", "4"}));
+}
+
+TEST(Channel, write_batch) {
+    Options options;
+    options.capacity = 64;
+    Channel wr {"channel-batch", SENDER, options};
+    std::string payload(100, 'b');
+    for (int i = 0; i < 62; ++i) {
+        ASSERT_TRUE(wr.write(payload));
+    }
+
+    // a batch goes in whole or not at all
+    std::vector<std::string> batch {"first", "second", "third"};
+    auto buffs = buffers_of(batch);
+    EXPECT_FALSE(wr.write_batch(buffs.data(), buffs.size()));
+    EXPECT_FALSE(wr.write_batch(buffs.data(), 0));
+    std::vector<std::string> holed {"one", "", "three"};
+    auto holed_buffs = buffers_of(holed);
+    EXPECT_FALSE(wr.write_batch(holed_buffs.data(), holed_buffs.size()));
+
+    // the reader comes along, drains the ring and gets the batch once it fits
+    reader<Channel> rd {"channel-batch"};
+    ASSERT_TRUE(rd.wait_for(62));
+    EXPECT_TRUE(wr.write_batch(buffs.data(), buffs.size()));
+    ASSERT_TRUE(rd.wait_for(65));
+    auto got = rd.got().got();
+    ASSERT_EQ(got.size(), 65u);
+    EXPECT_EQ(got[61], payload);
+    EXPECT_EQ(std::vector<std::string>(got.begin() + 62, got.end()), batch);
+
+    // more messages than slots never fit
+    std::vector<std::string> huge(65, "x");
+    auto huge_buffs = buffers_of(huge);
+    EXPECT_FALSE(wr.write_batch(huge_buffs.data(), huge_buffs.size()));
+    ASSERT_TRUE(wr.write("last"));
+    ASSERT_TRUE(rd.wait_for(66));
+    EXPECT_EQ(rd.got().got().back(), "last");
+}
+
+TEST(Channel, header_filter) {
+    Options options;
+    options.header_size = 8;
+    options.pool_size = static_cast<std::uint32_t>(PoolSize::MIN_POOL_SIZE);
+    Channel wr {"channel-header", SENDER, options};
+    reader<Channel> rd {"channel-header", 10, {}, std::make_shared<even_only>()};
+
+    // dropped messages give their payload back, a small pool does not run dry
+    std::string payload(4000, 'h');
+    for (std::uint64_t i = 0; i < 100; ++i) {
+        auto msg = std::to_string(i) + payload;
+        ASSERT_TRUE(wr.write(&i, msg.data(), msg.size())) << i;
+        if (i % 2 == 0) {
+            ASSERT_TRUE(rd.wait_for(i / 2 + 1)) << i;
+        }
+    }
+    // a message written without a header carries a zeroed one
+    ASSERT_TRUE(wr.write("plain"));
+    ASSERT_TRUE(rd.wait_for(51));
+    auto got = rd.got().got();
+    ASSERT_EQ(got.size(), 51u);
+    for (std::size_t i = 0; i < 50; ++i) {
+        EXPECT_EQ(got[i], std::to_string(i * 2) + payload);
+    }
+    EXPECT_EQ(got.back(), "plain");
+}
+
+TEST(Channel, stage_publish) {
+    Options options;
+    options.capacity = 64;
+    Channel wr {"channel-stage", SENDER, options};
+    reader<Channel> rd {"channel-stage"};
+
+    // staged messages stay with the writer until they are published together
+    for (auto const * msg : {"a", "b", "c"}) {
+        ASSERT_TRUE(wr.stage(msg, 1));
+    }
+    EXPECT_FALSE(wr.stage(nullptr, 1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(rd.got().size(), 0u);
+    ASSERT_TRUE(wr.publish());
+    ASSERT_TRUE(rd.wait_for(3));
+    EXPECT_EQ(rd.got().got(), (std::vector<std::string>{"a", "b", "c"}));
+
+    // nothing staged, or staged and dropped, publishes nothing
+    EXPECT_FALSE(wr.publish());
+    ASSERT_TRUE(wr.stage("x", 1));
+    wr.unstage();
+    EXPECT_FALSE(wr.publish());
+
+    // a set larger than the ring fails whole and is cleared all the same
+    for (int i = 0; i < 65; ++i) {
+        ASSERT_TRUE(wr.stage("y", 1));
+    }
+    EXPECT_FALSE(wr.publish());
+    EXPECT_FALSE(wr.publish());
+    ASSERT_TRUE(wr.stage("z", 1));
+    ASSERT_TRUE(wr.publish());
+    ASSERT_TRUE(rd.wait_for(4));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(rd.got().got(), (std::vector<std::string>{"a", "b", "c", "z"}));
+}
+
+TEST(Channel, publish_delivery) {
+    Channel wr {"channel-publish", SENDER};
+    reader<Channel> rd {"channel-publish"};
+
+    // without a callback a publish only reports through its result
+    ASSERT_TRUE(wr.stage("a", 1));
+    ASSERT_TRUE(wr.publish());
+    ASSERT_TRUE(rd.wait_for(1));
+
+    // with one, every publish reports once, failed or not
+    auto done = std::make_shared<deliveries>();
+    wr.set_callback(done);
+    ASSERT_TRUE(wr.stage("b", 1));
+    ASSERT_TRUE(wr.publish());
+    EXPECT_FALSE(wr.publish());
+    ASSERT_TRUE(rd.wait_for(2));
+    EXPECT_EQ(done->got(), (std::vector<ErrorCode>{ErrorCode::IPC_ERR_SUCCESS, ErrorCode::IPC_ERR_NOINIT}));
+    EXPECT_EQ(rd.got().got(), (std::vector<std::string>{"a", "b"}));
+}
+
+TEST(Channel, timed_write) {
+    Options options;
+    options.capacity = 64;
+    Channel wr {"channel-timed", SENDER, options};
+    for (int i = 0; i < 64; ++i) {
+        ASSERT_TRUE(wr.write(std::to_string(i)));
+    }
+
+    // nobody reads, a full ring times out
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(wr.write("late", 4, std::chrono::milliseconds(50)));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(50));
+
+    // a reader turning up frees the slots the writer waits for
+    std::unique_ptr<reader<Channel>> rd;
+    std::thread later {[&rd] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        rd = std::make_unique<reader<Channel>>("channel-timed");
+    }};
+    EXPECT_TRUE(wr.write("late", 4, std::chrono::milliseconds(5000)));
+    later.join();
+    ASSERT_TRUE(rd->wait_for(65));
+    EXPECT_EQ(rd->got().got().back(), "late");
+}
+
+TEST(Channel, loan_commit) {
+    Options options;
+    options.capacity = 64;
+    options.pool_size = static_cast<std::uint32_t>(PoolSize::MIN_POOL_SIZE);
+    Channel wr {"channel-loan", SENDER, options};
+
+    // discarded loans give their room back
+    std::vector<Buffer> loans;
+    for (Buffer loan; !(loan = wr.loan(8000)).empty();) {
+        loans.push_back(std::move(loan));
+    }
+    ASSERT_GT(loans.size(), 1u);
+    auto const fit = loans.size();
+    for (auto & loan : loans) {
+        wr.discard(loan);
+    }
+    loans.clear();
+    for (std::size_t i = 0; i < fit; ++i) {
+        loans.push_back(wr.loan(8000));
+        ASSERT_FALSE(loans.back().empty()) << i;
+    }
+    for (auto & loan : loans) {
+        wr.discard(loan);
+    }
+
+    for (int i = 0; i < 64; ++i) {
+        ASSERT_TRUE(wr.write(std::to_string(i)));
+    }
+    // a commit into a full ring fails and leaves the loan open, its room stays taken
+    auto loan = wr.loan(1000);
+    ASSERT_FALSE(loan.empty());
+    std::memset(loan.data(), 'L', loan.size());
+    EXPECT_FALSE(wr.commit(loan));
+    for (int i = 0; i < 100; ++i) {
+        auto other = wr.loan(1000);
+        ASSERT_FALSE(other.empty());
+        ASSERT_NE(other.data(), loan.data()) << i;
+        wr.discard(other);
+        EXPECT_FALSE(wr.commit(other));
+    }
+
+    reader<Channel> rd {"channel-loan"};
+    ASSERT_TRUE(rd.wait_for(64));
+    ASSERT_TRUE(wr.commit(loan));
+    EXPECT_FALSE(wr.commit(loan));
+    ASSERT_TRUE(rd.wait_for(65));
+    EXPECT_EQ(rd.got().got().back(), std::string(1000, 'L'));
+
+    // read payloads go back to the pool, it serves many times its size
+    for (int i = 0; i < 200; ++i) {
+        Buffer next;
+        for (int k = 0; (k < 1000) && (next = wr.loan(8000)).empty(); ++k) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        ASSERT_FALSE(next.empty()) << i;
+        std::memset(next.data(), 'a' + (i % 26), next.size());
+        ASSERT_TRUE(wr.commit(next)) << i;
+    }
+    ASSERT_TRUE(rd.wait_for(265));
+    EXPECT_EQ(rd.got().got().back(), std::string(8000, 'a' + (199 % 26)));
+}
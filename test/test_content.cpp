@@ -0,0 +1,1075 @@
+#include <vector>
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <Choose.hpp>
+#include <Queue.hpp>
+#include <core/Segment.hpp>
+
+#include "test.h"
+
+namespace {
+
+struct msg_t {
+    int pid_;
+    int dat_;
+
+    msg_t() = default;
+    msg_t(int p, int d) : pid_(p), dat_(d) {}
+};
+
+using queue_t = ipc::Queue<msg_t, ipc::detail::Choose<ipc::detail::Segment>>;
+
+constexpr int LoopCount = 100000;
+constexpr int SenderMax = 32;
+
+template <typename Que>
+void push(Que & que, int p, int d) {
+    while (!que.push(p, d)) {
+        std::this_thread::yield();
+    }
+}
+
+void test_contention(char const * name, int s_cnt, ipc::Options const & options = {}) {
+    ipc_ut::sender().start(static_cast<std::size_t>(s_cnt));
+    ipc_ut::reader().start(1);
+    ipc_ut::test_stopwatch sw;
+    std::atomic<int> ready { 0 };
+
+    queue_t rd_que;
+    ASSERT_TRUE(rd_que.open(name, options));
+    ASSERT_TRUE(rd_que.connect(ipc::RECEIVER));
+
+    for (int k = 0; k < s_cnt; ++k) {
+        ipc_ut::sender() << [name, &sw, &ready, s_cnt, k] {
+            queue_t que;
+            ASSERT_TRUE(que.open(name));
+            ASSERT_TRUE(que.connect(ipc::SENDER));
+            ready.fetch_add(1, std::memory_order_acq_rel);
+            while (ready.load(std::memory_order_acquire) != s_cnt) {
+                std::this_thread::yield();
+            }
+            sw.start();
+            for (int i = 0; i < LoopCount; ++i) {
+                push(que, k, i);
+            }
+            que.disconnect();
+        };
+    }
+    ipc_ut::reader() << [&rd_que, s_cnt] {
+        std::vector<int> last(static_cast<std::size_t>(s_cnt), -1);
+        msg_t msg;
+        for (int n = 0; n < s_cnt * LoopCount;) {
+            if (!rd_que.pop(msg, [](bool) { return true; })) {
+                std::this_thread::yield();
+                continue;
+            }
+            ASSERT_TRUE((msg.pid_ >= 0) && (msg.pid_ < s_cnt));
+            // every producer's messages must arrive once and in order
+            ASSERT_EQ(last[msg.pid_] + 1, msg.dat_);
+            last[msg.pid_] = msg.dat_;
+            ++n;
+        }
+    };
+
+    ipc_ut::sender().wait_for_done();
+    ipc_ut::reader().wait_for_done();
+    sw.print_elapsed(s_cnt, 1, LoopCount, name);
+    rd_que.disconnect();
+}
+
+// s_cnt producers against r_cnt competing readers, every message must be consumed exactly once.
+void test_workqueue(char const * name, int s_cnt, int r_cnt) {
+    ipc::Options options {};
+    options.competing = true;
+    ipc_ut::sender().start(static_cast<std::size_t>(s_cnt));
+    ipc_ut::reader().start(static_cast<std::size_t>(r_cnt));
+    ipc_ut::test_stopwatch sw;
+    std::atomic<int> ready { 0 };
+    std::atomic<int> consumed { 0 };
+    std::vector<std::atomic<char>> seen(static_cast<std::size_t>(s_cnt * LoopCount));
+
+    queue_t que;
+    ASSERT_TRUE(que.open(name, options));
+    for (int k = 0; k < r_cnt; ++k) {
+        ipc_ut::reader() << [name, &ready, &consumed, &seen, s_cnt, r_cnt] {
+            queue_t rd_que;
+            ASSERT_TRUE(rd_que.open(name));
+            ASSERT_TRUE(rd_que.connect(ipc::RECEIVER));
+            ready.fetch_add(1, std::memory_order_acq_rel);
+            msg_t got[16];
+            while (consumed.load(std::memory_order_acquire) < s_cnt * LoopCount) {
+                auto n = rd_que.pop_n(got, 16, [&](msg_t const & msg, void const *) {
+                    EXPECT_EQ(seen[static_cast<std::size_t>(msg.pid_ * LoopCount + msg.dat_)].exchange(1), 0);
+                    return true;
+                });
+                if (n == 0) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                consumed.fetch_add(static_cast<int>(n), std::memory_order_acq_rel);
+            }
+            rd_que.disconnect();
+        };
+    }
+    while (ready.load(std::memory_order_acquire) != r_cnt) {
+        std::this_thread::yield();
+    }
+    for (int k = 0; k < s_cnt; ++k) {
+        ipc_ut::sender() << [name, &sw, k] {
+            queue_t wr_que;
+            ASSERT_TRUE(wr_que.open(name));
+            ASSERT_TRUE(wr_que.connect(ipc::SENDER));
+            sw.start();
+            for (int i = 0; i < LoopCount; ++i) {
+                push(wr_que, k, i);
+            }
+        };
+    }
+
+    ipc_ut::sender().wait_for_done();
+    ipc_ut::reader().wait_for_done();
+    sw.print_elapsed<1>(s_cnt, r_cnt, s_cnt * LoopCount, name);
+    EXPECT_EQ(consumed.load(), s_cnt * LoopCount);
+}
+
+} // internal-linkage
+
+TEST(Content, mpmc_contention) {
+    for (int i = 1; i <= SenderMax; i *= 2) {
+        test_contention(("content-mpmc-" + std::to_string(i)).c_str(), i);
+    }
+}
+
+TEST(Content, capacity) {
+    queue_t wr_que;
+    EXPECT_FALSE(wr_que.open("content-capacity", {100}));
+    ASSERT_TRUE(wr_que.open("content-capacity", {4096}));
+    ASSERT_TRUE(wr_que.connect(ipc::SENDER));
+    EXPECT_EQ(wr_que.capacity(), 4096u);
+
+    // later endpoints adopt the capacity of the creator
+    queue_t rd_que;
+    ASSERT_TRUE(rd_que.open("content-capacity"));
+    ASSERT_TRUE(rd_que.connect(ipc::RECEIVER));
+    EXPECT_EQ(rd_que.capacity(), 4096u);
+
+    int n = 0;
+    while (wr_que.push(0, n)) ++n;
+    EXPECT_EQ(n, 4096);
+
+    msg_t msg;
+    for (int i = 0; i < n; ++i) {
+        ASSERT_TRUE(rd_que.pop(msg, [](bool) { return true; }));
+        ASSERT_EQ(msg.dat_, i);
+    }
+    EXPECT_FALSE(rd_que.pop(msg, [](bool) { return true; }));
+    EXPECT_TRUE(wr_que.push(0, n));
+}
+
+TEST(Content, open_race) {
+    // endpoints opening a ring at once all end up on the one the first of them created
+    for (int round = 0; round < 20; ++round) {
+        auto const name = "content-open-race-" + std::to_string(round);
+        std::atomic<int> ready { 0 };
+        std::vector<std::uint32_t> seen(8);
+        std::vector<std::thread> threads;
+        for (std::uint32_t k = 0; k < seen.size(); ++k) {
+            threads.emplace_back([&, k] {
+                ready.fetch_add(1, std::memory_order_acq_rel);
+                while (ready.load(std::memory_order_acquire) < static_cast<int>(seen.size())) {
+                    std::this_thread::yield();
+                }
+                queue_t que;
+                ipc::Options options {};
+                options.capacity = 64u << (k % 4);
+                if (que.open(name.c_str(), options)) {
+                    seen[k] = que.capacity();
+                }
+                ready.fetch_add(1, std::memory_order_acq_rel);
+                while (ready.load(std::memory_order_acquire) < static_cast<int>(seen.size() * 2)) {
+                    std::this_thread::yield();
+                }
+            });
+        }
+        for (auto & t : threads) t.join();
+        EXPECT_NE(seen[0], 0u);
+        for (auto cap : seen) {
+            EXPECT_EQ(cap, seen[0]) << round;
+        }
+    }
+}
+
+TEST(Content, batch) {
+    queue_t wr_que;
+    ASSERT_TRUE(wr_que.open("content-batch", {64}));
+    ASSERT_TRUE(wr_que.connect(ipc::SENDER));
+    queue_t rd_que;
+    ASSERT_TRUE(rd_que.open("content-batch"));
+    ASSERT_TRUE(rd_que.connect(ipc::RECEIVER));
+
+    msg_t items[48];
+    for (int i = 0; i < 48; ++i) items[i] = msg_t{1, i};
+    ASSERT_TRUE(wr_que.push_n(items, 48));
+    // a batch is queued completely or not at all
+    EXPECT_FALSE(wr_que.push_n(items, 17));
+    EXPECT_EQ(wr_que.segment()->wr(), 48u);
+    ASSERT_TRUE(wr_que.push_n(items, 16));
+
+    msg_t got[64];
+    int seen = 0;
+    EXPECT_EQ(rd_que.pop_n(got, 64, [&seen](msg_t const & msg, void const *) {
+        EXPECT_EQ(msg.dat_, seen % 48);
+        ++seen;
+        return true;
+    }), 64u);
+    EXPECT_EQ(seen, 64);
+    EXPECT_EQ(rd_que.segment()->cursor(rd_que.connected_id()), 64u);
+    EXPECT_EQ(rd_que.pop_n(got, 64, [](msg_t const &, void const *) { return true; }), 0u);
+}
+
+TEST(Content, batch_atomic) {
+    constexpr int s_cnt = 4;
+    constexpr int SetSize = 8;
+    queue_t rd_que;
+    ASSERT_TRUE(rd_que.open("content-batch-mp", {64}));
+    ASSERT_TRUE(rd_que.connect(ipc::RECEIVER));
+
+    ipc_ut::sender().start(s_cnt);
+    for (int k = 0; k < s_cnt; ++k) {
+        ipc_ut::sender() << [k] {
+            queue_t que;
+            ASSERT_TRUE(que.open("content-batch-mp"));
+            ASSERT_TRUE(que.connect(ipc::SENDER));
+            msg_t items[SetSize];
+            for (int i = 0; i < LoopCount / SetSize; ++i) {
+                for (int j = 0; j < SetSize; ++j) items[j] = msg_t{k, j};
+                // a writer stalling halfway through its set must not expose the first half
+                while (!que.push_n(items, SetSize, [](std::uint32_t j, void *) {
+                    if (j == SetSize / 2) std::this_thread::yield();
+                })) {
+                    std::this_thread::yield();
+                }
+            }
+        };
+    }
+
+    // a drain stops in front of a set still being written, never in the middle of one
+    msg_t got[64];
+    int total = 0;
+    while (total < s_cnt * LoopCount) {
+        int pid = -1;
+        int next = 0;
+        auto n = rd_que.pop_n(got, 64, [&](msg_t const & msg, void const *) {
+            if (next == 0) pid = msg.pid_;
+            EXPECT_EQ(msg.pid_, pid);
+            EXPECT_EQ(msg.dat_, next);
+            next = (next + 1) % SetSize;
+            return true;
+        });
+        EXPECT_EQ(n % SetSize, 0u);
+        total += static_cast<int>(n);
+        if (!n) std::this_thread::yield();
+    }
+    ipc_ut::sender().wait_for_done();
+}
+
+TEST(Content, reader_cursors) {
+    queue_t wr_que;
+    ASSERT_TRUE(wr_que.open("content-readers", {64}));
+    ASSERT_TRUE(wr_que.connect(ipc::SENDER));
+    queue_t fast, slow;
+    ASSERT_TRUE(fast.open("content-readers"));
+    ASSERT_TRUE(fast.connect(ipc::RECEIVER));
+    ASSERT_TRUE(slow.open("content-readers"));
+    ASSERT_TRUE(slow.connect(ipc::RECEIVER));
+
+    msg_t msg;
+    for (int i = 0; i < 64; ++i) {
+        ASSERT_TRUE(wr_que.push(0, i));
+        ASSERT_TRUE(fast.pop(msg, [](bool) { return true; }));
+    }
+    // the slow reader holds the ring, and writers can tell who it is
+    EXPECT_FALSE(wr_que.push(0, 64));
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> readers;
+    wr_que.segment()->for_each_reader([&readers](std::uint32_t id, std::uint32_t cursor, std::uint32_t) {
+        readers.emplace_back(id, cursor);
+    });
+    ASSERT_EQ(readers.size(), 2u);
+    for (auto const & rd : readers) {
+        EXPECT_EQ(rd.second, (rd.first == fast.connected_id()) ? 64u : 0u);
+    }
+
+    // once it is gone the ring moves on with the remaining reader
+    EXPECT_TRUE(slow.disconnect());
+    EXPECT_TRUE(wr_que.push(0, 64));
+    ASSERT_TRUE(fast.pop(msg, [](bool) { return true; }));
+    EXPECT_EQ(msg.dat_, 64);
+}
+
+TEST(Content, late_reader) {
+    queue_t wr_que;
+    ASSERT_TRUE(wr_que.open("content-late", {64}));
+    ASSERT_TRUE(wr_que.connect(ipc::SENDER));
+    queue_t first;
+    ASSERT_TRUE(first.open("content-late"));
+    ASSERT_TRUE(first.connect(ipc::RECEIVER));
+
+    msg_t msg;
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(wr_que.push(0, i));
+    }
+    for (int i = 0; i < 8; ++i) {
+        ASSERT_TRUE(first.pop(msg, [](bool) { return true; }));
+    }
+
+    // none of the messages written before it came were counted for a late reader, consumed or not
+    queue_t late;
+    ASSERT_TRUE(late.open("content-late"));
+    ASSERT_TRUE(late.connect(ipc::RECEIVER));
+    EXPECT_TRUE(late.empty());
+    EXPECT_FALSE(late.pop(msg, [](bool) { return true; }));
+    ASSERT_TRUE(wr_que.push(0, 10));
+    ASSERT_TRUE(late.pop(msg, [](bool) { return true; }));
+    EXPECT_EQ(msg.dat_, 10);
+    EXPECT_TRUE(late.empty());
+    for (int i = 8; i <= 10; ++i) {
+        ASSERT_TRUE(first.pop(msg, [](bool) { return true; }));
+        EXPECT_EQ(msg.dat_, i);
+    }
+
+    // alone a reader resumes where the last one stopped
+    ASSERT_TRUE(first.disconnect());
+    ASSERT_TRUE(late.disconnect());
+    ASSERT_TRUE(wr_que.push(0, 11));
+    ASSERT_TRUE(late.connect(ipc::RECEIVER));
+    ASSERT_TRUE(late.pop(msg, [](bool) { return true; }));
+    EXPECT_EQ(msg.dat_, 11);
+}
+
+TEST(Content, late_reader_count) {
+    queue_t wr_que;
+    ASSERT_TRUE(wr_que.open("content-late-count", {64}));
+    ASSERT_TRUE(wr_que.connect(ipc::SENDER));
+    queue_t first, late, later;
+    ASSERT_TRUE(first.open("content-late-count"));
+    ASSERT_TRUE(first.connect(ipc::RECEIVER));
+    ASSERT_TRUE(late.open("content-late-count"));
+    ASSERT_TRUE(later.open("content-late-count"));
+
+    // a reader coming between the count and the ticket gets the message, one coming after the ticket does not
+    auto const roster = wr_que.roster();
+    EXPECT_EQ(wr_que.consumers(), 1u);
+    ASSERT_TRUE(late.connect(ipc::RECEIVER));
+    EXPECT_NE(wr_que.roster(), roster);
+    std::uint32_t counted = 0;
+    ASSERT_TRUE(wr_que.push_inline(msg_t{0, 1}, nullptr, 0, 0, nullptr, [&](std::uint32_t ticket) {
+        ASSERT_TRUE(later.connect(ipc::RECEIVER));
+        counted = wr_que.consumers(0, ticket);
+    }));
+    EXPECT_EQ(counted, 2u);
+    EXPECT_EQ(wr_que.consumers(), 3u);
+
+    msg_t msg;
+    ASSERT_TRUE(first.pop(msg, [](bool) { return true; }));
+    ASSERT_TRUE(late.pop(msg, [](bool) { return true; }));
+    EXPECT_EQ(msg.dat_, 1);
+    EXPECT_FALSE(later.pop(msg, [](bool) { return true; }));
+}
+
+TEST(Content, inline_payload) {
+    queue_t wr_que;
+    EXPECT_FALSE(wr_que.open("content-inline", {64, 4096}));
+    ASSERT_TRUE(wr_que.open("content-inline", {64, 30}));
+    ASSERT_TRUE(wr_que.connect(ipc::SENDER));
+    queue_t rd_que;
+    ASSERT_TRUE(rd_que.open("content-inline"));
+    ASSERT_TRUE(rd_que.connect(ipc::RECEIVER));
+    EXPECT_EQ(rd_que.inline_size(), 30u);
+
+    char const text[] = "small telemetry payload";
+    EXPECT_FALSE(wr_que.push_inline(msg_t{1, 0}, text, 31));
+    for (int i = 0; i < 64; ++i) {
+        ASSERT_TRUE(wr_que.push_inline(msg_t{1, i}, text, sizeof(text)));
+    }
+
+    msg_t got[64];
+    int seen = 0;
+    EXPECT_EQ(rd_que.pop_n(got, 64, [&](msg_t const & msg, void const * extra) {
+        EXPECT_EQ(msg.dat_, seen++);
+        EXPECT_STREQ(static_cast<char const *>(extra), text);
+        return true;
+    }), 64u);
+}
+
+TEST(Content, lanes) {
+    ipc::Options options {};
+    options.capacity = 64;
+    options.lanes = true;
+    queue_t rd_que;
+    ASSERT_TRUE(rd_que.open("content-lanes", options));
+    ASSERT_TRUE(rd_que.connect(ipc::RECEIVER));
+    // a lane has a single consumer
+    queue_t other;
+    ASSERT_TRUE(other.open("content-lanes"));
+    EXPECT_FALSE(other.connect(ipc::RECEIVER));
+
+    queue_t busy, quiet;
+    ASSERT_TRUE(busy.open("content-lanes"));
+    ASSERT_TRUE(busy.connect(ipc::SENDER));
+    ASSERT_TRUE(quiet.open("content-lanes"));
+    ASSERT_TRUE(quiet.connect(ipc::SENDER));
+
+    // every sender owns the whole capacity
+    int n = 0;
+    while (busy.push(0, n)) ++n;
+    EXPECT_EQ(n, 64);
+    ASSERT_TRUE(quiet.push(1, 0));
+    ASSERT_TRUE(quiet.push(1, 1));
+    EXPECT_EQ(rd_que.segment()->wr(), 66u);
+
+    // the reader takes turns between the lanes
+    msg_t got[4];
+    std::vector<int> order;
+    EXPECT_EQ(rd_que.pop_n(got, 4, [&order](msg_t const & msg, void const *) {
+        order.push_back(msg.pid_);
+        return true;
+    }), 4u);
+    EXPECT_EQ(order, (std::vector<int>{0, 1, 0, 1}));
+    EXPECT_TRUE(busy.push(0, n));
+
+    msg_t msg;
+    for (int i = 2; i <= n; ++i) {
+        ASSERT_TRUE(rd_que.pop(msg, [](bool) { return true; }));
+        ASSERT_EQ(msg.pid_, 0);
+        ASSERT_EQ(msg.dat_, i);
+    }
+    EXPECT_TRUE(rd_que.empty());
+}
+
+TEST(Content, lanes_contention) {
+    ipc::Options options {};
+    options.lanes = true;
+    test_contention("content-lanes-8", 8, options);
+}
+
+TEST(Content, padded_slots) {
+    ipc::Options padded {};
+    padded.padded = true;
+    queue_t que;
+    ASSERT_TRUE(que.open("content-padded", padded));
+    EXPECT_EQ(que.segment()->stride() % 64, 0u);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(que.segment()->at(1)) % 64, 0u);
+
+    // the same contention run on packed and on cache line sized slots
+    for (int i = 1; i <= SenderMax; i *= 4) {
+        test_contention(("content-packed-" + std::to_string(i)).c_str(), i);
+        test_contention(("content-padded-" + std::to_string(i)).c_str(), i, padded);
+    }
+}
+
+TEST(Content, overwrite) {
+    ipc::Options options {};
+    options.capacity = 64;
+    options.overwrite = true;
+    queue_t wr_que;
+    EXPECT_FALSE(wr_que.open("content-overwrite", options));
+    options.inline_size = 8;
+    ASSERT_TRUE(wr_que.open("content-overwrite", options));
+    ASSERT_TRUE(wr_que.connect(ipc::SENDER));
+    queue_t rd_que;
+    ASSERT_TRUE(rd_que.open("content-overwrite"));
+    ASSERT_TRUE(rd_que.connect(ipc::RECEIVER));
+
+    // the writer never waits for the reader
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(wr_que.push(0, i));
+    }
+
+    // the lapped reader jumps to the oldest message left and learns how many it lost
+    msg_t got[64];
+    EXPECT_EQ(rd_que.pop_n(got, 64, [](msg_t const &, void const *) { return true; }), 0u);
+    EXPECT_EQ(rd_que.skipped(), 36u);
+    int seen = 36;
+    EXPECT_EQ(rd_que.pop_n(got, 64, [&seen](msg_t const & msg, void const *) {
+        EXPECT_EQ(msg.dat_, seen++);
+        return true;
+    }), 64u);
+    EXPECT_TRUE(rd_que.empty());
+
+    // a late reader starts with what is still in the ring
+    ASSERT_TRUE(wr_que.push(0, 100));
+    queue_t late;
+    ASSERT_TRUE(late.open("content-overwrite"));
+    ASSERT_TRUE(late.connect(ipc::RECEIVER));
+    msg_t msg;
+    ASSERT_TRUE(late.pop(msg, [](bool) { return true; }));
+    EXPECT_EQ(msg.dat_, 37);
+    EXPECT_EQ(late.skipped(), 0u);
+}
+
+TEST(Content, overwrite_contention) {
+    constexpr int s_cnt = 4;
+    ipc::Options options {};
+    options.capacity = 64;
+    options.inline_size = 8;
+    options.overwrite = true;
+    queue_t rd_que;
+    ASSERT_TRUE(rd_que.open("content-overwrite-mp", options));
+    ASSERT_TRUE(rd_que.connect(ipc::RECEIVER));
+
+    ipc_ut::sender().start(s_cnt);
+    for (int k = 0; k < s_cnt; ++k) {
+        ipc_ut::sender() << [k] {
+            queue_t que;
+            ASSERT_TRUE(que.open("content-overwrite-mp"));
+            ASSERT_TRUE(que.connect(ipc::SENDER));
+            for (int i = 0; i < LoopCount; ++i) {
+                ASSERT_TRUE(que.push(k, i));
+            }
+        };
+    }
+    // whatever survives arrives untorn and in order per producer, the rest is accounted as skipped
+    std::vector<int> last(s_cnt, -1);
+    std::uint32_t delivered = 0;
+    msg_t got[32];
+    auto drain = [&] {
+        return rd_que.pop_n(got, 32, [&](msg_t const & msg, void const *) {
+            EXPECT_TRUE((msg.pid_ >= 0) && (msg.pid_ < s_cnt));
+            EXPECT_LT(last[msg.pid_], msg.dat_);
+            last[msg.pid_] = msg.dat_;
+            ++delivered;
+            return true;
+        });
+    };
+    while (rd_que.segment()->wr() < static_cast<std::uint32_t>(s_cnt * LoopCount)) {
+        drain();
+    }
+    ipc_ut::sender().wait_for_done();
+    while (!rd_que.empty()) {
+        drain();
+    }
+    EXPECT_EQ(delivered + rd_que.skipped(), static_cast<std::uint32_t>(s_cnt * LoopCount));
+}
+
+TEST(Content, priorities) {
+    ipc::Options options {};
+    options.capacity = 64;
+    options.priorities = 3;
+    queue_t wr_que;
+    ASSERT_TRUE(wr_que.open("content-priorities", options));
+    ASSERT_TRUE(wr_que.connect(ipc::SENDER));
+    queue_t rd_que;
+    ASSERT_TRUE(rd_que.open("content-priorities"));
+    ASSERT_TRUE(rd_que.connect(ipc::RECEIVER));
+    EXPECT_EQ(rd_que.priorities(), 3u);
+
+    // every class has a ring of its own
+    int n = 0;
+    while (wr_que.push(0, n)) ++n;
+    EXPECT_EQ(n, 64);
+    EXPECT_FALSE(wr_que.push_to(3, 2, 0));
+    ASSERT_TRUE(wr_que.push_to(1, 1, 0));
+    ASSERT_TRUE(wr_que.push_to(2, 2, 0));
+    ASSERT_TRUE(wr_que.push_to(1, 1, 1));
+    EXPECT_EQ(rd_que.segment()->wr(), 67u);
+
+    // higher classes are drained first, each in order
+    msg_t got[4];
+    std::vector<std::pair<int, int>> order;
+    EXPECT_EQ(rd_que.pop_n(got, 4, [&order](msg_t const & msg, void const *) {
+        order.emplace_back(msg.pid_, msg.dat_);
+        return true;
+    }), 4u);
+    EXPECT_EQ(order, (std::vector<std::pair<int, int>>{{2, 0}, {1, 0}, {1, 1}, {0, 0}}));
+
+    ASSERT_TRUE(wr_que.push_to(2, 2, 1));
+    msg_t msg;
+    ASSERT_TRUE(rd_que.pop(msg, [](bool) { return true; }));
+    EXPECT_EQ(msg.pid_, 2);
+    for (int i = 1; i < n; ++i) {
+        ASSERT_TRUE(rd_que.pop(msg, [](bool) { return true; }));
+        ASSERT_EQ(msg.dat_, i);
+    }
+    EXPECT_TRUE(rd_que.empty());
+}
+
+TEST(Content, blocking_push) {
+    ipc::Options options {};
+    options.capacity = 64;
+    queue_t wr_que;
+    ASSERT_TRUE(wr_que.open("content-blocking", options));
+    ASSERT_TRUE(wr_que.connect(ipc::SENDER));
+    queue_t rd_que;
+    ASSERT_TRUE(rd_que.open("content-blocking"));
+    ASSERT_TRUE(rd_que.connect(ipc::RECEIVER));
+
+    for (int i = 0; i < 64; ++i) {
+        ASSERT_TRUE(wr_que.push(0, i));
+    }
+    // a full ring times out
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(wr_que.push_wait([&] { return wr_que.push(0, 64); }, 50));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(50));
+    EXPECT_FALSE(wr_que.push_wait([&] { return wr_que.push(0, 64); }, 0));
+
+    // the writer sleeps until the reader frees a slot, it does not retry in between
+    std::thread reader {[&rd_que] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+        msg_t msg;
+        EXPECT_TRUE(rd_que.pop(msg, [](bool) { return true; }));
+        EXPECT_EQ(msg.dat_, 0);
+    }};
+    auto cpu = std::clock();
+    int tries = 0;
+    EXPECT_TRUE(wr_que.push_wait([&] { ++tries; return wr_que.push(0, 64); },
+                                 static_cast<std::uint64_t>(ipc::TimeOut::INVALID_TIMEOUT)));
+    reader.join();
+    EXPECT_LT(std::clock() - cpu, CLOCKS_PER_SEC / 100);
+    EXPECT_LE(tries, 3);
+
+    msg_t got[64];
+    EXPECT_EQ(rd_que.pop_n(got, 64, [](msg_t const &, void const *) { return true; }), 64u);
+    EXPECT_EQ(got[63].dat_, 64);
+}
+
+TEST(Content, chained) {
+    ipc::Options options {};
+    options.capacity = 64;
+    options.chained = true;
+    queue_t wr_que;
+    ASSERT_TRUE(wr_que.open("content-chained", options));
+    ASSERT_TRUE(wr_que.connect(ipc::SENDER));
+    queue_t rd_que;
+    ASSERT_TRUE(rd_que.open("content-chained"));
+    ASSERT_TRUE(rd_que.connect(ipc::RECEIVER));
+    queue_t other;
+    ASSERT_TRUE(other.open("content-chained"));
+    EXPECT_FALSE(other.connect(ipc::RECEIVER));
+
+    auto exists = [](std::uint32_t gen) {
+        ipc::detail::Handle handle;
+        return handle.acquire(ipc::detail::chain_name("content-chained", gen).c_str(), 0, ipc::detail::open);
+    };
+
+    // a burst spills over into overflow segments instead of failing
+    for (int i = 0; i < 200; ++i) {
+        ASSERT_TRUE(wr_que.push(0, i));
+    }
+    EXPECT_TRUE(exists(1));
+    EXPECT_TRUE(exists(3));
+    EXPECT_FALSE(exists(4));
+
+    msg_t got[32];
+    int expect = 0;
+    auto drain = [&] {
+        return rd_que.pop_n(got, 32, [&](msg_t const & msg, void const *) {
+            EXPECT_EQ(msg.dat_, expect++);
+            return true;
+        });
+    };
+    while (drain()) {}
+    EXPECT_EQ(expect, 200);
+    EXPECT_TRUE(rd_que.empty());
+    // drained segments are gone, the reader waits in the last one
+    EXPECT_FALSE(exists(1));
+    EXPECT_FALSE(exists(2));
+    EXPECT_TRUE(exists(3));
+
+    // the writers return to the first segment, the last overflow segment goes once it is drained
+    ASSERT_TRUE(wr_que.push(0, 200));
+    ASSERT_TRUE(wr_que.push(0, 201));
+    EXPECT_EQ(drain(), 2u);
+    EXPECT_FALSE(exists(3));
+    EXPECT_EQ(rd_que.segment()->head().load(), 0u);
+    EXPECT_EQ(rd_que.segment()->tail().load(), 0u);
+
+    // and do it again
+    for (int i = 202; i < 400; ++i) {
+        ASSERT_TRUE(wr_que.push(0, i));
+    }
+    while (drain()) {}
+    EXPECT_EQ(expect, 400);
+}
+
+TEST(Content, chained_contention) {
+    ipc::Options options {};
+    options.capacity = 64;
+    options.chained = true;
+    test_contention("content-chained-mp", 4, options);
+}
+
+TEST(Content, workqueue) {
+    ipc::Options options {};
+    options.capacity = 64;
+    options.competing = true;
+    queue_t wr_que;
+    ASSERT_TRUE(wr_que.open("content-workqueue", options));
+    ASSERT_TRUE(wr_que.connect(ipc::SENDER));
+    queue_t rd_a, rd_b;
+    ASSERT_TRUE(rd_a.open("content-workqueue"));
+    ASSERT_TRUE(rd_a.connect(ipc::RECEIVER));
+    ASSERT_TRUE(rd_b.open("content-workqueue"));
+    ASSERT_TRUE(rd_b.connect(ipc::RECEIVER));
+    EXPECT_EQ(wr_que.consumers(), 1u);
+
+    // the readers split the messages between them
+    for (int i = 0; i < 6; ++i) {
+        ASSERT_TRUE(wr_que.push(0, i));
+    }
+    msg_t msg;
+    ASSERT_TRUE(rd_a.pop(msg, [](bool) { return true; }));
+    EXPECT_EQ(msg.dat_, 0);
+    ASSERT_TRUE(rd_b.pop(msg, [](bool) { return true; }));
+    EXPECT_EQ(msg.dat_, 1);
+    msg_t got[4];
+    EXPECT_EQ(rd_a.pop_n(got, 4, [](msg_t const &, void const *) { return true; }), 4u);
+    EXPECT_EQ(got[0].dat_, 2);
+    EXPECT_EQ(got[3].dat_, 5);
+    EXPECT_FALSE(rd_b.pop(msg, [](bool) { return true; }));
+
+    // slots are handed back as they are claimed, and messages wait for a reader to come
+    rd_a.disconnect();
+    rd_b.disconnect();
+    for (int i = 0; i < 64; ++i) {
+        ASSERT_TRUE(wr_que.push(0, i));
+    }
+    EXPECT_FALSE(wr_que.push(0, 64));
+    ASSERT_TRUE(rd_b.connect(ipc::RECEIVER));
+    ASSERT_TRUE(rd_b.pop(msg, [](bool) { return true; }));
+    EXPECT_EQ(msg.dat_, 0);
+    EXPECT_TRUE(wr_que.push(0, 64));
+}
+
+TEST(Content, workqueue_contention) {
+    for (int i = 1; i <= 8; i *= 2) {
+        test_workqueue(("content-workqueue-" + std::to_string(i)).c_str(), 4, i);
+    }
+}
+
+TEST(Content, groups) {
+    ipc::Options options {};
+    options.capacity = 64;
+    queue_t wr_que;
+    ASSERT_TRUE(wr_que.open("content-groups", options));
+    ASSERT_TRUE(wr_que.connect(ipc::SENDER));
+    queue_t solo, g1, g2, h1;
+    for (auto *que : {&solo, &g1, &g2, &h1}) {
+        ASSERT_TRUE(que->open("content-groups"));
+        ASSERT_TRUE(que->connect(ipc::RECEIVER));
+    }
+    ASSERT_TRUE(g1.join("g"));
+    ASSERT_TRUE(g2.join("g"));
+    ASSERT_TRUE(h1.join("h"));
+    EXPECT_FALSE(h1.join("g"));
+    EXPECT_EQ(wr_que.consumers(), 3u);
+
+    for (int i = 0; i < 8; ++i) {
+        ASSERT_TRUE(wr_que.push(0, i));
+    }
+    auto drain = [](queue_t & que, std::uint32_t max) {
+        std::vector<int> got;
+        msg_t items[8];
+        que.pop_n(items, max, [&got](msg_t const & msg, void const *) {
+            got.push_back(msg.dat_);
+            return true;
+        });
+        return got;
+    };
+    // every group gets every message, each one goes to a single member of a group
+    EXPECT_EQ(drain(solo, 8), (std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7}));
+    EXPECT_EQ(drain(g1, 3), (std::vector<int>{0, 1, 2}));
+    EXPECT_EQ(drain(g2, 8), (std::vector<int>{3, 4, 5, 6, 7}));
+    EXPECT_TRUE(drain(g1, 8).empty());
+    EXPECT_EQ(drain(h1, 8), (std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7}));
+
+    // the writers wait for the slowest group, not for each of its members
+    for (int i = 0; i < 64; ++i) {
+        ASSERT_TRUE(wr_que.push(0, i));
+    }
+    EXPECT_FALSE(wr_que.push(0, 64));
+    drain(solo, 8);
+    drain(h1, 8);
+    EXPECT_FALSE(wr_que.push(0, 64));
+    EXPECT_EQ(drain(g2, 1), (std::vector<int>{0}));
+    EXPECT_TRUE(wr_que.push(0, 64));
+
+    // the last member takes the group down
+    g1.disconnect();
+    g2.disconnect();
+    EXPECT_EQ(wr_que.consumers(), 2u);
+    ASSERT_TRUE(g1.connect(ipc::RECEIVER));
+    ASSERT_TRUE(g1.join("g"));
+    EXPECT_EQ(wr_que.consumers(), 3u);
+}
+
+TEST(Content, conflate) {
+    ipc::Options options {};
+    options.capacity = 64;
+    options.conflate = true;
+    queue_t wr_que;
+    EXPECT_FALSE(wr_que.open("content-conflate", options));
+    options.inline_size = 8;
+    ASSERT_TRUE(wr_que.open("content-conflate", options));
+    ASSERT_TRUE(wr_que.connect(ipc::SENDER));
+    queue_t rd_que;
+    ASSERT_TRUE(rd_que.open("content-conflate"));
+    ASSERT_TRUE(rd_que.connect(ipc::RECEIVER));
+    queue_t other;
+    ASSERT_TRUE(other.open("content-conflate"));
+    EXPECT_FALSE(other.connect(ipc::RECEIVER));
+
+    // a burst far beyond the capacity only takes one slot per key
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_TRUE(wr_que.push_keyed(static_cast<std::uint64_t>(i % 8), msg_t{i % 8, i}));
+    }
+    EXPECT_EQ(wr_que.segment()->wr(), 8u);
+
+    // the lagging reader sees the latest value of every key, in the order the keys first came up
+    msg_t got[64];
+    int k = 0;
+    EXPECT_EQ(rd_que.pop_n(got, 64, [&k](msg_t const & msg, void const *) {
+        EXPECT_EQ(msg.pid_, k);
+        EXPECT_EQ(msg.dat_, 992 + k++);
+        return true;
+    }), 8u);
+    EXPECT_TRUE(rd_que.empty());
+
+    // a key the reader already took gets a new slot
+    ASSERT_TRUE(wr_que.push_keyed(3, msg_t{3, 1000}));
+    ASSERT_TRUE(wr_que.push_keyed(3, msg_t{3, 1001}));
+    EXPECT_EQ(wr_que.segment()->wr(), 9u);
+    msg_t msg;
+    ASSERT_TRUE(rd_que.pop(msg, [](bool) { return true; }));
+    EXPECT_EQ(msg.dat_, 1001);
+    EXPECT_TRUE(rd_que.empty());
+
+    // laps later a taken slot is still told apart from a committed one, nothing is written into it
+    for (int lap = 0; lap < 3; ++lap) {
+        for (int i = 0; i < 64; ++i) {
+            ASSERT_TRUE(wr_que.push_keyed(static_cast<std::uint64_t>(i), msg_t{i, lap}));
+            ASSERT_TRUE(rd_que.pop(msg, [](bool) { return true; }));
+            EXPECT_EQ(msg.pid_, i);
+            EXPECT_EQ(msg.dat_, lap);
+        }
+    }
+    EXPECT_TRUE(rd_que.empty());
+}
+
+TEST(Content, conflate_contention) {
+    constexpr int s_cnt = 4;
+    constexpr int k_cnt = 16;
+    ipc::Options options {};
+    options.capacity = 64;
+    options.inline_size = 8;
+    options.conflate = true;
+    queue_t rd_que;
+    ASSERT_TRUE(rd_que.open("content-conflate-mp", options));
+    ASSERT_TRUE(rd_que.connect(ipc::RECEIVER));
+
+    // every sender owns a set of keys and writes increasing values to them
+    std::atomic<int> done { 0 };
+    ipc_ut::sender().start(s_cnt);
+    for (int s = 0; s < s_cnt; ++s) {
+        ipc_ut::sender() << [s, &done] {
+            queue_t que;
+            ASSERT_TRUE(que.open("content-conflate-mp"));
+            ASSERT_TRUE(que.connect(ipc::SENDER));
+            for (int i = 0; i < LoopCount; ++i) {
+                auto key = static_cast<std::uint64_t>(s * k_cnt + i % k_cnt);
+                while (!que.push_keyed(key, msg_t{static_cast<int>(key), i})) {
+                    std::this_thread::yield();
+                }
+            }
+            ++done;
+        };
+    }
+
+    // values never go backwards per key, and the last one written to each key arrives
+    std::vector<int> last(s_cnt * k_cnt, -1);
+    msg_t got[32];
+    auto drain = [&] {
+        return rd_que.pop_n(got, 32, [&last](msg_t const & msg, void const *) {
+            EXPECT_GT(msg.dat_, last[msg.pid_]);
+            last[msg.pid_] = msg.dat_;
+            return true;
+        });
+    };
+    while (done < s_cnt) {
+        if (!drain()) std::this_thread::yield();
+    }
+    while (drain()) ;
+    ipc_ut::sender().wait_for_done();
+    for (int key = 0; key < s_cnt * k_cnt; ++key) {
+        EXPECT_EQ(last[key], LoopCount - k_cnt + key % k_cnt);
+    }
+}
+
+TEST(Content, user_header) {
+    ipc::Options options {};
+    options.capacity = 64;
+    options.inline_size = 8;
+    options.header_size = 4;
+    queue_t wr_que;
+    EXPECT_FALSE(wr_que.open("content-header", options));
+    options.header_size = 40;
+    EXPECT_FALSE(wr_que.open("content-header", options));
+    options.header_size = 16;
+    ASSERT_TRUE(wr_que.open("content-header", options));
+    ASSERT_TRUE(wr_que.connect(ipc::SENDER));
+    EXPECT_EQ(wr_que.header_size(), 16u);
+    queue_t rd_que;
+    ASSERT_TRUE(rd_que.open("content-header"));
+    ASSERT_TRUE(rd_que.connect(ipc::RECEIVER));
+
+    // the header sits behind the inline payload, a message without one gets it zeroed
+    char const header[16] = "type-7";
+    int const payload = 42;
+    ASSERT_TRUE(wr_que.push_inline(msg_t{0, 1}, &payload, sizeof(payload), 0, header));
+    ASSERT_TRUE(wr_que.push(0, 2));
+    ASSERT_TRUE(wr_que.push_inline(msg_t{0, 3}, nullptr, 0, 0, header));
+
+    msg_t got[4];
+    char const zero[16] {};
+    int n = 0;
+    EXPECT_EQ(rd_que.pop_n(got, 4, [&](msg_t const & msg, void const * extra) {
+        auto const * hdr = rd_que.header_of(extra);
+        EXPECT_EQ(std::memcmp(hdr, (msg.dat_ == 2) ? zero : header, sizeof(header)), 0);
+        if (msg.dat_ == 1) {
+            EXPECT_EQ(std::memcmp(extra, &payload, sizeof(payload)), 0);
+        }
+        ++n;
+        return true;
+    }), 3u);
+    EXPECT_EQ(n, 3);
+}
+
+TEST(Content, sequence) {
+    ipc::Options options {};
+    options.capacity = 64;
+    queue_t wr_que;
+    ASSERT_TRUE(wr_que.open("content-sequence", options));
+    ASSERT_TRUE(wr_que.connect(ipc::SENDER));
+    queue_t slow;
+    ASSERT_TRUE(slow.open("content-sequence"));
+    ASSERT_TRUE(slow.connect(ipc::RECEIVER));
+    queue_t fast;
+    ASSERT_TRUE(fast.open("content-sequence"));
+    ASSERT_TRUE(fast.connect(ipc::RECEIVER));
+
+    // every reader numbers a message alike
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(wr_que.push(0, i));
+    }
+    msg_t got[64];
+    for (auto * que : {&slow, &fast}) {
+        EXPECT_EQ(que->pop_n(got, 64, [que](msg_t const & msg, void const *) {
+            EXPECT_EQ(que->sequence(), static_cast<std::uint64_t>(msg.dat_));
+            EXPECT_EQ(que->lost(), 0u);
+            return true;
+        }), 10u);
+    }
+
+    // a reader coming back after the writers reused its slots learns what it missed meanwhile
+    ASSERT_TRUE(slow.disconnect());
+    for (int i = 10; i < 74; ++i) {
+        ASSERT_TRUE(wr_que.push(0, i));
+    }
+    EXPECT_EQ(fast.pop_n(got, 64, [](msg_t const &, void const *) { return true; }), 64u);
+    ASSERT_TRUE(wr_que.push(0, 74));
+    ASSERT_TRUE(slow.connect(ipc::RECEIVER));
+    ASSERT_TRUE(wr_que.push(0, 75));
+    std::vector<std::uint64_t> lost;
+    EXPECT_EQ(slow.pop_n(got, 64, [&](msg_t const & msg, void const *) {
+        EXPECT_EQ(slow.sequence(), static_cast<std::uint64_t>(msg.dat_));
+        lost.push_back(slow.lost());
+        return true;
+    }), 1u);
+    EXPECT_EQ(lost, (std::vector<std::uint64_t>{65}));
+}
+
+TEST(Content, sequence_wrap) {
+    using ipc::detail::Content;
+    // every process extends a ticket from the base the segment keeps, on both sides of a wrap alike
+    EXPECT_EQ(Content::extend(0xFFFFFFF0ull, 5u), 0x100000005ull);
+    EXPECT_EQ(Content::extend(0x100000005ull, 0xFFFFFFF0u), 0xFFFFFFF0ull);
+    EXPECT_EQ(Content::extend(0x340000000ull, 0x40000010u), 0x340000010ull);
+    EXPECT_EQ(Content::extend(0x340000000ull, 0x3FFFFFF0u), 0x33FFFFFF0ull);
+}
+
+TEST(Content, sequence_lossy) {
+    ipc::Options options {};
+    options.capacity = 64;
+    options.inline_size = 8;
+    options.overwrite = true;
+    queue_t wr_que;
+    ASSERT_TRUE(wr_que.open("content-sequence-lossy", options));
+    ASSERT_TRUE(wr_que.connect(ipc::SENDER));
+    queue_t rd_que;
+    ASSERT_TRUE(rd_que.open("content-sequence-lossy"));
+    ASSERT_TRUE(rd_que.connect(ipc::RECEIVER));
+
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(wr_que.push(0, i));
+    }
+    msg_t got[64];
+    std::uint64_t lost = 0;
+    std::uint32_t n = 0;
+    for (int k = 0; k < 2; ++k) {
+        n += rd_que.pop_n(got, 64, [&](msg_t const & msg, void const *) {
+            EXPECT_EQ(rd_que.sequence(), static_cast<std::uint64_t>(msg.dat_));
+            lost += rd_que.lost();
+            return true;
+        });
+    }
+    EXPECT_EQ(n, 64u);
+    EXPECT_EQ(lost, 36u);
+    EXPECT_EQ(lost, rd_que.skipped());
+}
+
+TEST(Content, retain) {
+    ipc::Options options {};
+    options.capacity = 64;
+    options.retain = 16;
+    queue_t wr_que;
+    EXPECT_FALSE(wr_que.open("content-retain", options));
+    options.inline_size = 8;
+    ASSERT_TRUE(wr_que.open("content-retain", options));
+    ASSERT_TRUE(wr_que.connect(ipc::SENDER));
+
+    // nobody reads, the writer still goes on and the ring keeps the last messages
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(wr_que.push(0, i));
+    }
+
+    // a reader joins at the live end and seeks back into the window
+    queue_t rd_que;
+    ASSERT_TRUE(rd_que.open("content-retain"));
+    ASSERT_TRUE(rd_que.connect(ipc::RECEIVER));
+    EXPECT_TRUE(rd_que.empty());
+    EXPECT_FALSE(rd_que.seek(20));
+    EXPECT_FALSE(rd_que.seek(101));
+    ASSERT_TRUE(rd_que.rewind(10));
+    msg_t got[64];
+    int next = 90;
+    EXPECT_EQ(rd_que.pop_n(got, 64, [&](msg_t const & msg, void const *) {
+        EXPECT_EQ(msg.dat_, next);
+        EXPECT_EQ(rd_que.sequence(), static_cast<std::uint64_t>(next++));
+        return true;
+    }), 10u);
+
+    ASSERT_TRUE(rd_que.seek(84));
+    next = 84;
+    EXPECT_EQ(rd_que.pop_n(got, 64, [&](msg_t const & msg, void const *) {
+        EXPECT_EQ(msg.dat_, next++);
+        return true;
+    }), 16u);
+
+    // a reader standing in the window holds the writers back like any slow reader
+    ASSERT_TRUE(rd_que.rewind(16));
+    int pushed = 0;
+    while (wr_que.push(0, 100 + pushed)) ++pushed;
+    EXPECT_EQ(pushed, 48);
+    EXPECT_EQ(rd_que.pop_n(got, 64, [](msg_t const &, void const *) { return true; }), 64u);
+}
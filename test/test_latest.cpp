@@ -0,0 +1,73 @@
+#include <atomic>
+#include <ipc/Latest.h>
+
+#include "test.h"
+
+namespace {
+
+struct pose_t {
+    long seq_;
+    long x_, y_, z_;
+};
+
+} // internal-linkage
+
+TEST(Latest, overwrite) {
+    ipc::Latest<pose_t> wr { "latest-overwrite" };
+    ASSERT_TRUE(wr.valid());
+    ipc::Latest<pose_t> rd { "latest-overwrite" };
+    ASSERT_TRUE(rd.valid());
+
+    pose_t pose {};
+    EXPECT_FALSE(rd.read(pose));
+    EXPECT_EQ(rd.version(), 0u);
+    for (long i = 1; i <= 3; ++i) {
+        ASSERT_TRUE(wr.write(pose_t{i, i, i, i}));
+    }
+    // only the newest value is kept
+    ASSERT_TRUE(rd.read(pose));
+    EXPECT_EQ(pose.seq_, 3);
+    EXPECT_EQ(rd.version(), 3u);
+
+    // the creator decides the size of the value
+    ipc::Latest<int> other { "latest-overwrite" };
+    EXPECT_FALSE(other.valid());
+}
+
+TEST(Latest, torn_free) {
+    ipc_ut::sender().start(2);
+    ipc_ut::reader().start(2);
+    std::atomic<bool> done { false };
+
+    ipc::Latest<pose_t> keep { "latest-torn" };
+    ASSERT_TRUE(keep.valid());
+    for (long k = 0; k < 2; ++k) {
+        ipc_ut::sender() << [k] {
+            ipc::Latest<pose_t> wr { "latest-torn" };
+            ASSERT_TRUE(wr.valid());
+            for (long i = 0; i < 200000; ++i) {
+                long v = i * 2 + k;
+                ASSERT_TRUE(wr.write(pose_t{v, v, v, v}));
+            }
+        };
+    }
+    for (int k = 0; k < 2; ++k) {
+        ipc_ut::reader() << [&done] {
+            ipc::Latest<pose_t> rd { "latest-torn" };
+            ASSERT_TRUE(rd.valid());
+            pose_t pose {};
+            while (!done.load(std::memory_order_acquire)) {
+                if (!rd.read(pose)) continue;
+                // every field comes from the same write
+                ASSERT_EQ(pose.x_, pose.seq_);
+                ASSERT_EQ(pose.y_, pose.seq_);
+                ASSERT_EQ(pose.z_, pose.seq_);
+            }
+        };
+    }
+
+    ipc_ut::sender().wait_for_done();
+    done.store(true, std::memory_order_release);
+    ipc_ut::reader().wait_for_done();
+    EXPECT_EQ(keep.version(), 400000u);
+}
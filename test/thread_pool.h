@@ -34,7 +34,8 @@ class thread_pool final {
         if (pool->quit_) return;
         if (pool->jobs_.empty()) {
           pool->waiting_cnt_ += 1;
-          ipc::detail::Guard ([pool]
+          // named, so the count drops when the worker stops waiting, not right away
+          auto guard_waiting = ipc::detail::Guard ([pool]
           {
             pool->waiting_cnt_ -= 1;
           });